@@ -0,0 +1,371 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <malloc.h>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <sys/resource.h>
+#include "clidict.hpp"
+
+using namespace radix_dict;
+using namespace cli_dict;
+
+namespace {
+  constexpr size_t queries_count {4096};
+  constexpr size_t completions_limit {20};
+
+  ///  Words of a benchmark
+  enum Corpus : int64_t {short_words, medium_words, long_words, shell_commands};
+
+  //  Random words of letters a-z with length from min_len to max_len
+  vector<std::string> makeRandom(size_t count, size_t min_len, size_t max_len, unsigned seed) {
+    std::mt19937 gen {seed};
+    std::uniform_int_distribution<int> letter {'a', 'z'};
+    std::uniform_int_distribution<size_t> length {min_len, max_len};
+    vector<std::string> words(count);
+    for (auto& word : words) {
+      word.resize(length(gen));
+      for (auto& ch : word) {
+        ch = static_cast<char>(letter(gen));
+      }
+    }
+    return words;
+  }
+  //  Shell like commands - tool, subcommand and option separated by spaces, options get a number when all
+  //  combinations are used
+  vector<std::string> makeCommands(size_t count) {
+    static const vector<std::string> tools {"git", "docker", "kubectl", "cargo", "npm", "systemctl", "journalctl", "apt",
+                                            "ip", "ssh", "tar", "find", "grep", "make", "cmake", "ctest", "helm", "terraform",
+                                            "aws", "gcloud", "az", "pip", "conda", "go", "rustup", "brew", "podman", "virsh"};
+    static const vector<std::string> subs {"add", "build", "commit", "config", "create", "delete", "describe", "diff", "exec",
+                                           "get", "init", "inspect", "install", "list", "log", "logs", "pull", "push", "remove",
+                                           "restart", "run", "search", "show", "start", "status", "stop", "update", "upgrade"};
+    static const vector<std::string> options {"--all", "--amend", "--force", "--help", "--namespace", "--output", "--quiet",
+                                              "--recursive", "--verbose", "--version", "--watch", "--dry-run", "--tag", "-f"};
+    vector<std::string> commands;
+    commands.reserve(count);
+    size_t combinations {tools.size() * subs.size() * options.size()};
+    for (size_t pos = 0; pos < count; ++pos) {
+      size_t combination {pos % combinations};
+      std::string command {tools[combination % tools.size()] + ' ' + subs[combination / tools.size() % subs.size()] + ' ' +
+                           options[combination / tools.size() / subs.size()]};
+      if (pos >= combinations) {
+        command += std::to_string(pos / combinations);
+      }
+      commands.push_back(std::move(command));
+    }
+    std::shuffle(commands.begin(), commands.end(), std::mt19937{7});
+    return commands;
+  }
+  //  Words of a corpus, made once for every size
+  const vector<std::string>& corpusWords(int64_t corpus, size_t count) {
+    static std::map<std::pair<int64_t, size_t>, vector<std::string>> made;
+    auto& words {made[{corpus, count}]};
+    if (words.empty()) {
+      switch (corpus) {
+        case short_words :
+          words = makeRandom(count, 2, 6, 1);
+          break;
+        case medium_words :
+          words = makeRandom(count, 4, 16, 1);
+          break;
+        case long_words :
+          words = makeRandom(count, 16, 64, 1);
+          break;
+        default :
+          words = makeCommands(count);
+      }
+    }
+    return words;
+  }
+  //  Lookups of inserted words in a random order
+  vector<std::string> makeQueries(const vector<std::string>& words, size_t count = queries_count) {
+    std::mt19937 gen {2};
+    std::uniform_int_distribution<size_t> pos {0, words.size() - 1};
+    vector<std::string> queries(count);
+    for (auto& query : queries) {
+      query = words[pos(gen)];
+    }
+    return queries;
+  }
+  //  Prefixes of inserted words - a half of a word
+  vector<std::string> makePrefixes(const vector<std::string>& words) {
+    auto prefixes {makeQueries(words)};
+    for (auto& prefix : prefixes) {
+      prefix.resize((prefix.size() + 1) / 2);
+    }
+    return prefixes;
+  }
+
+  //  Heap memory in use in KB, resident memory is not a measure here - freed memory is reused by a next container
+  size_t heapKb() {
+    return mallinfo2().uordblks / 1024;
+  }
+  //  Peak resident memory of the process in KB
+  size_t peakKb() {
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss);
+  }
+
+  //  Containers under benchmarks - ins, exact get and up to completions_limit items by a prefix
+  struct RadixBench {
+    RadixTree<char> tree;
+    void ins(const std::string& word) {tree.ins(word);}
+    bool get(const std::string& word) const {return tree.get(word) != nullptr;}
+    size_t complete(const std::string& prefix) const {return static_cast<size_t>(ranges::distance(tree.completions(prefix, completions_limit)));}
+  };
+  struct DictBench {
+    Dict<char> dict {' '};
+    void ins(const std::string& word) {dict.ins(word);}
+    bool get(const std::string& word) const {return dict.get(word) != nullptr;}
+    size_t complete(const std::string& prefix) const {return static_cast<size_t>(ranges::distance(dict.completions(prefix, completions_limit)));}
+  };
+  //  Baselines - prefix search as a range from lower_bound of a prefix
+  const std::string& itemKey(const std::string& item) {return item;}
+  template <typename V> const std::string& itemKey(const std::pair<const std::string, V>& item) {return item.first;}
+  template <typename C> size_t completeOrdered(const C& container, const std::string& prefix) {
+    size_t count {0};
+    for (auto item_it {container.lower_bound(prefix)}; count < completions_limit && item_it != container.end() && itemKey(*item_it).starts_with(prefix); ++item_it) {
+      ++count;
+    }
+    return count;
+  }
+  struct SetBench {
+    std::set<std::string> set;
+    void ins(const std::string& word) {set.insert(word);}
+    bool get(const std::string& word) const {return set.contains(word);}
+    size_t complete(const std::string& prefix) const {return completeOrdered(set, prefix);}
+  };
+  struct MapBench {
+    std::map<std::string, size_t> map;
+    void ins(const std::string& word) {map.emplace(word, map.size());}
+    bool get(const std::string& word) const {return map.contains(word);}
+    size_t complete(const std::string& prefix) const {return completeOrdered(map, prefix);}
+  };
+
+  //  Sizes from 100 to 1M for every corpus
+  void corpusArgs(benchmark::internal::Benchmark* bench) {
+    bench->ArgNames({"size", "corpus"});
+    for (int64_t corpus : {short_words, medium_words, long_words, shell_commands}) {
+      for (int64_t size : {100, 10'000, 1'000'000}) {
+        bench->Args({size, corpus});
+      }
+    }
+  }
+  template <typename C> unique_ptr<C> build(const vector<std::string>& words) {
+    auto container {make_unique<C>()};
+    for (const auto& word : words) {
+      container->ins(word);
+    }
+    return container;
+  }
+}
+
+template <typename C> static void BM_Insert(benchmark::State& state) {
+  const auto& words {corpusWords(state.range(1), state.range(0))};
+
+  //  Memory of a container, measured once
+  size_t before {heapKb()};
+  auto measured {build<C>(words)};
+  state.counters["heap_kb"] = static_cast<double>(heapKb() - std::min(before, heapKb()));
+  measured.reset();
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(build<C>(words));
+  }
+  state.SetItemsProcessed(state.iterations() * words.size());
+  state.counters["peak_rss_kb"] = static_cast<double>(peakKb());
+}
+BENCHMARK_TEMPLATE(BM_Insert, RadixBench)->Apply(corpusArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Insert, DictBench)->Apply(corpusArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Insert, SetBench)->Apply(corpusArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Insert, MapBench)->Apply(corpusArgs)->Unit(benchmark::kMillisecond);
+
+//  Bulk insert of 1M words of a corpus by range(1) threads, one thread is the word by word insert
+static void BM_BulkInsert(benchmark::State& state) {
+  const auto& words {corpusWords(state.range(0), 1'000'000)};
+  for (auto _ : state) {
+    RadixTree<char> tree;
+    benchmark::DoNotOptimize(tree.bulk_insert(words, static_cast<size_t>(state.range(1))));
+  }
+  state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_BulkInsert)->ArgNames({"corpus", "threads"})->ArgsProduct({{medium_words, shell_commands}, {1, 2, 4, 8}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+//  Plugin set of range(0) commands added to a base set of 100K commands - merge of trees against inserts one by one
+template <bool Merge> static void BM_MergePlugin(benchmark::State& state) {
+  const auto& words {corpusWords(shell_commands, 100'000)};
+  const auto plugin_words {makeRandom(static_cast<size_t>(state.range(0)), 4, 16, 5)};
+  for (auto _ : state) {
+    state.PauseTiming();
+    RadixTree<char> base, plugin;
+    ranges::for_each(words, [&base](const auto& word){base.ins(word);});
+    ranges::for_each(plugin_words, [&plugin](const auto& word){plugin.ins(word);});
+    state.ResumeTiming();
+    if constexpr (Merge) {
+      benchmark::DoNotOptimize(base.merge(std::move(plugin)));
+    } else {
+      for (auto word : plugin.completions("")) {
+        benchmark::DoNotOptimize(base.ins(word));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * plugin_words.size());
+}
+BENCHMARK_TEMPLATE(BM_MergePlugin, true)->Arg(1'000)->Arg(100'000)->Iterations(10);
+BENCHMARK_TEMPLATE(BM_MergePlugin, false)->Arg(1'000)->Arg(100'000)->Iterations(10);
+
+template <typename C> static void BM_Get(benchmark::State& state) {
+  const auto& words {corpusWords(state.range(1), state.range(0))};
+  auto container {build<C>(words)};
+  auto queries {makeQueries(words)};
+  for (auto _ : state) {
+    for (const auto& query : queries) {
+      benchmark::DoNotOptimize(container->get(query));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+  state.counters["peak_rss_kb"] = static_cast<double>(peakKb());
+}
+BENCHMARK_TEMPLATE(BM_Get, RadixBench)->Apply(corpusArgs);
+BENCHMARK_TEMPLATE(BM_Get, DictBench)->Apply(corpusArgs);
+BENCHMARK_TEMPLATE(BM_Get, SetBench)->Apply(corpusArgs);
+BENCHMARK_TEMPLATE(BM_Get, MapBench)->Apply(corpusArgs);
+
+template <typename C> static void BM_Complete(benchmark::State& state) {
+  const auto& words {corpusWords(state.range(1), state.range(0))};
+  auto container {build<C>(words)};
+  auto prefixes {makePrefixes(words)};
+  for (auto _ : state) {
+    for (const auto& prefix : prefixes) {
+      benchmark::DoNotOptimize(container->complete(prefix));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * prefixes.size());
+  state.counters["peak_rss_kb"] = static_cast<double>(peakKb());
+}
+BENCHMARK_TEMPLATE(BM_Complete, RadixBench)->Apply(corpusArgs);
+BENCHMARK_TEMPLATE(BM_Complete, DictBench)->Apply(corpusArgs);
+BENCHMARK_TEMPLATE(BM_Complete, SetBench)->Apply(corpusArgs);
+BENCHMARK_TEMPLATE(BM_Complete, MapBench)->Apply(corpusArgs);
+
+//  Dict lookups of shell commands with an abbreviated post part - "git co" for "git commit --amend"
+static void BM_DictDelimiter(benchmark::State& state) {
+  const auto& words {corpusWords(shell_commands, state.range(0))};
+  auto container {build<DictBench>(words)};
+  auto queries {makeQueries(words)};
+  for (auto& query : queries) {
+    query.resize(std::min(query.size(), query.find(' ') + 3));
+  }
+  for (auto _ : state) {
+    for (const auto& query : queries) {
+      benchmark::DoNotOptimize(container->dict.get(query));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+BENCHMARK(BM_DictDelimiter)->Arg(100)->Arg(10'000)->Arg(1'000'000);
+
+//  Batched lookups against the same number of single get calls
+static void BM_RadixGetSingle(benchmark::State& state) {
+  const auto& words {corpusWords(medium_words, state.range(0))};
+  auto container {build<RadixBench>(words)};
+  auto queries {makeQueries(words)};
+  for (auto _ : state) {
+    for (const auto& query : queries) {
+      benchmark::DoNotOptimize(container->tree.get(query));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+BENCHMARK(BM_RadixGetSingle)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+static void BM_RadixGetBatch(benchmark::State& state) {
+  const auto& words {corpusWords(medium_words, state.range(0))};
+  auto container {build<RadixBench>(words)};
+  auto queries {makeQueries(words)};
+  vector<unique_ptr<vector<char>>> results(queries.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(container->tree.get_batch(span<const std::string>{queries}, span{results}));
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+BENCHMARK(BM_RadixGetBatch)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+static void BM_DictGetSingle(benchmark::State& state) {
+  const auto& words {corpusWords(shell_commands, state.range(0))};
+  auto container {build<DictBench>(words)};
+  auto queries {makeQueries(words)};
+  for (auto _ : state) {
+    for (const auto& query : queries) {
+      benchmark::DoNotOptimize(container->dict.get(query));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+BENCHMARK(BM_DictGetSingle)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+static void BM_DictGetTo(benchmark::State& state) {
+  const auto& words {corpusWords(shell_commands, state.range(0))};
+  auto container {build<DictBench>(words)};
+  auto queries {makeQueries(words)};
+  std::array<char, 1024> buffer {};
+  for (auto _ : state) {
+    for (const auto& query : queries) {
+      benchmark::DoNotOptimize(container->dict.get_to(query, buffer.begin()));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+BENCHMARK(BM_DictGetTo)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+static void BM_DictGetBatch(benchmark::State& state) {
+  const auto& words {corpusWords(shell_commands, state.range(0))};
+  auto container {build<DictBench>(words)};
+  auto queries {makeQueries(words)};
+  vector<unique_ptr<vector<char>>> results(queries.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(container->dict.get_batch(span<const std::string>{queries}, span{results}));
+  }
+  state.SetItemsProcessed(state.iterations() * queries.size());
+}
+BENCHMARK(BM_DictGetBatch)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+//  Label comparison kernel against a letter by letter loop. Pairs of labels of range(0) letters differ at a random
+//  position, or not at all
+template <typename T, bool Kernel> static void BM_LabelCompare(benchmark::State& state) {
+  const size_t len {static_cast<size_t>(state.range(0))};
+  std::mt19937 gen {11};
+  std::uniform_int_distribution<size_t> diff_pos {0, len};
+  vector<pair<vector<T>, vector<T>>> labels(256);
+  for (auto& [left, right] : labels) {
+    left.resize(len);
+    for (auto& letter : left) {
+      letter = static_cast<T>('a' + gen() % 26);
+    }
+    right = left;
+    if (size_t pos {diff_pos(gen)}; pos < len) {
+      right[pos] = static_cast<T>('A');
+    }
+  }
+  for (auto _ : state) {
+    for (const auto& [left, right] : labels) {
+      if constexpr (Kernel) {
+        benchmark::DoNotOptimize(commonPrefix<T>(left, right));
+      } else {
+        benchmark::DoNotOptimize(ranges::mismatch(left, right).in1);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * labels.size());
+}
+BENCHMARK_TEMPLATE(BM_LabelCompare, char, true)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_LabelCompare, char, false)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_LabelCompare, char16_t, true)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(BM_LabelCompare, char16_t, false)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+
+BENCHMARK_MAIN();
@@ -44,12 +44,45 @@ SOFTWARE.
  *  For single string commands - radix_dict::RadixTree<char> radix {{'t', 'e', 's', 't', '1'}, {'t', 'e', 's', 't', '2'}};
  *  For delimiter separated commands commands - 
  *  cli_dict::Dict<char> dict{'-', {{'t', 'e', 's', 't', '1', '-', 't', 'e', 's', 't', '1'}, {'t', 'e', 's', 't', '2', '-', 't', 'e', 's', 't', '2'}}};
+ *  Words could be passed as vectors, spans, strings or string views - radix.get("te"), dict.contains(std::string_view{"test1-test1"}).
+ *  All commands starting with a prefix, made lazily one by one - for (auto word : dict.completions("te", 20)) {...}
+ *  Fixed command sets built at compile time, no startup cost and no heap - static constexpr auto cmd
+ *  {radix_dict::makeStaticTree<[]{return std::array{"test1", "test2"};}>()}; cmd.get("te") gives a span of static letters.
+ *  Typo tolerant lookup, nearest items first - for (auto& match : dict.fuzzy_get("tets1", 2)) {match.word, match.distance}
+ *  Erase with path re-compression - dict.erase("test1-test1"), memory after heavy churn is recovered by dict.compact().
+ *  Tree shape and memory - dict.stats(), operation counters (built with -DCLIDICT_STATS, free otherwise) - dict.counters().
+ *  Commands of any depth, abbreviated segment by segment - cli_dict::HierDict<char> cmd{' '}; cmd.ins("tool sub action"); cmd.get("t s a").
+ *  Many lookups at once, interleaved to hide memory latency - dict.get_batch(span<const std::string>{words}, span{results}).
+ *  Labels of byte, two and four byte letters are compared 16 bytes at once with SSE2, 32 bytes with AVX2 (-mavx2).
+ *  Many words at once by threads - dict.bulk_insert(words, 4), parts with different leading letters are built in parallel.
+ *  Plugin sets joined without inserting again - base.merge(std::move(plugin)), paths are split only where they differ.
+ *  Shared option sets kept once - dict.minimize() turns a built dictionary into a DAWG, lookups stay the same.
+ *  Case insensitive commands - cli_dict::Dict<char, std::allocator<char>, radix_dict::CaseInsensitiveTraits<char>> dict{' '};
+ *   own letter folding (_ as -) by a traits type with static T key(T).
+ *  Lookup without allocations - std::array<char, 256> buf; auto end {dict.get_to("gi pu", buf.begin())}; or dict.get_view(word)->copy(out).
+ *  Per keystroke lookup - auto cur {dict.cursor()}; cur.push('t'); cur.pop(); cur.extension(), cur.candidates(), cur.complete().
+ *  Ambiguity and paged menus in O(prefix length) - dict.count_prefix("te"), dict.is_unique("tel"), dict.kth("te", 20), dict.rank("test1").
+ *  Command dispatch in one descent - cli_dict::DictMap<char, Handler> cmds{'-'}; cmds.ins("test1-run", handler); if (auto h {cmds.find("te-r")}) (*h)();
+ *  Memory from an own allocator or memory resource - std::pmr::monotonic_buffer_resource arena;
+ *  cli_dict::pmr::Dict<char> dict{'-', &arena}, or cli_dict::Dict<char, MyAllocator<char>> dict{'-', MyAllocator<char>{...}}.
+ *
+ *  Compiled read only dictionary - dict.save("cmd.img"), then in any process
+ *  radix_dict::MappedImage file{"cmd.img"}; cli_dict::FrozenDict<char> frozen{file.bytes()}; frozen.get("t");
+ *  a HierDict image is read by cli_dict::FrozenHierDict<char>.
+ *
+ *  Kept on disk with a journal - cli_dict::JournalDict<char> dict{'-', "cmd.img"}; dict.ins("test1-a") is journaled,
+ *   other processes pick changes up by dict.reload() in O(changes), dict.checkpoint() writes a new image.
+ *  Shared by threads, readers are never blocked by inserts - cli_dict::ConcurrentDict<char> shared{'-'}; shared.ins("test1-a") in one thread,
+ *  shared.get("te") in others, shared.get_to("te", buf.begin()) allocates nothing.
  *
  * 
  * \section install Compilation/installation
  *  Could be used a c++ header file or installed as internal library:
  *    cmake .. -DCMAKE_INSTALL_PREFIX:PATH=/your/installation/path
  *    cmake --build . --config Release --target install -- -j $(nproc)
+ *  Benchmarks (Google Benchmark) - cmake .. -DBUILD_BENCH=ON, then run bench/clidict_bench. Insert, get, prefix completion
+ *  and Dict delimiter lookups for 100 to 1M words of short, medium, long random words and shell commands (corpus 0-3), with
+ *  std::set/std::map baselines, heap usage and peak RSS counters - bench/clidict_bench --benchmark_filter='Get<.*>/size:10000/'
  * 
  * 
  */
@@ -62,6 +95,7 @@ SOFTWARE.
 #include <string_view>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <forward_list>
 #include <variant>
@@ -71,7 +105,43 @@ SOFTWARE.
 #include <ranges>
 #include <algorithm>
 #include <utility>
+#include <optional>
+#include <array>
+#include <numeric>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include <typeinfo>
+#include <span>
+#include <cstdint>
+#include <limits>
+#include <bit>
+#include <type_traits>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <exception>
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+///  Operation counters (levels descended, node splits, failed lookups) are built only with CLIDICT_STATS defined,
+///  otherwise counting statements are dropped
+#if defined(CLIDICT_STATS)
+#define CLIDICT_STAT(statement) statement
+#else
+#define CLIDICT_STAT(statement)
+#endif
 
 using std::initializer_list;
 using std::map;
@@ -84,6 +154,7 @@ using std::variant;
 using std::vector;
 using std::unordered_map;
 using std::pair;
+using std::span;
 
 
 namespace ranges = std::ranges;
@@ -94,369 +165,3990 @@ namespace views = std::ranges::views;
 
 
 
+
+
 namespace radix_dict{
-  template <typename T> class RadixTree;
+  ///  Index of a node inside of a NodeArena
+  using node_id = std::uint32_t;
+  ///  Index of a missing node (no branch, no postfix tree)
+  inline constexpr node_id no_node {std::numeric_limits<node_id>::max()};
+
+  ///  Letter traits of a tree, in the style of std::char_traits. Letters of the same key are equal, branches are
+  ///  ordered by keys (keyLess). Keys are taken going down a tree, labels keep letters of a first inserted word
+  template <typename T> struct LetterTraits {
+    static constexpr T key(const T& letter) noexcept {return letter;}
+  };
+  ///  Case insensitive latin letters
+  template <typename T> struct CaseInsensitiveTraits {
+    static constexpr T key(const T& letter) noexcept {
+      return letter >= T('A') && letter <= T('Z') ? static_cast<T>(letter - T('A') + T('a')) : letter;
+    }
+  };
+  ///  Traits of letters - a key of a letter gives its order and equality
+  template <typename Traits, typename T> concept LetterTraitsOf = requires (const T& letter) {
+    {Traits::key(letter)} -> std::convertible_to<T>;
+  };
+  ///  Letters are compared as they are
+  template <typename Traits, typename T> inline constexpr bool plain_traits {std::same_as<Traits, LetterTraits<T>>};
+
+  template <typename T, typename Alloc = std::allocator<T>, LetterTraitsOf<T> Traits = LetterTraits<T>> class RadixTree;
+
+  ///  Character types - words of them could be passed as strings and string views
+  template <typename T> concept CharType = std::same_as<T, char> || std::same_as<T, wchar_t> || std::same_as<T, char8_t> ||
+                                           std::same_as<T, char16_t> || std::same_as<T, char32_t>;
+  ///  Order of letter keys - the order of std::basic_string for characters (char_traits, char as unsigned char),
+  ///  so words sorted as strings are sorted as keys
+  template <typename T> constexpr bool keyLess(const T& left, const T& right) noexcept {
+    if constexpr (CharType<T>) {
+      return std::char_traits<T>::lt(left, right);
+    } else {
+      return left < right;
+    }
+  }
+  ///  Anything could be viewed as a contiguous sequence of letters - span, vector, string, string view, string literal
+  template <typename W, typename T> concept WordOf = std::convertible_to<const W&, span<const T>> ||
+                                                     (CharType<T> && std::convertible_to<const W&, std::basic_string_view<T>>);
+  ///  View a word as a span of letters without copying, strings are taken without terminating zero
+  template <typename T, typename W> requires WordOf<W, T> constexpr span<const T> wordSpan(const W& word) noexcept {
+    if constexpr (CharType<T> && std::convertible_to<const W&, std::basic_string_view<T>>) {
+      std::basic_string_view<T> view {word};
+      return {view.data(), view.size()};
+    } else {
+      return span<const T>{word};
+    }
+  }
+
+  ///  Kind of a node branches set, picked by branches count and upgraded on insert
+  enum class BranchKind : std::uint8_t {
+    none,     //  No branches
+    node4,    //  Up to 4 sorted keys, linear search
+    node16,   //  Up to 16 sorted keys, SIMD search for integral letters
+    node48,   //  Up to 48 branches with a direct 256 letters index (single byte letters only)
+    node256,  //  Direct 256 slots table (single byte letters only)
+    sorted    //  Any number of sorted keys, binary search (wide letters)
+  };
+
+  ///  Shape and memory of a tree with its postfix trees, see RadixTree::stats
+  struct TreeStats {
+    size_t nodes {0}; //  Reachable nodes, roots included, shared ones once
+    size_t words {0}; //  Nodes with an inserted word end
+    size_t postfix_trees {0};
+    size_t max_depth {0}; //  Levels below a root, postfix trees go on from levels of their nodes
+    vector<size_t> depth_nodes; //  Number of nodes at every level
+    size_t max_fanout {0};
+    vector<size_t> fanout_nodes; //  Number of nodes with every number of branches
+    size_t kind_nodes[6] {}; //  Number of nodes with every BranchKind of a branches set
+    size_t letters_bytes {0}; //  Labels pool
+    size_t branches_bytes {0}; //  Branches sets of all kinds
+    size_t nodes_bytes {0}; //  Node blocks
+  };
+  ///  Operation counters of a tree, all zero unless built with CLIDICT_STATS
+  struct OpCounters {
+    size_t inserts {0};
+    size_t lookups {0}; //  get and contains calls
+    size_t failed_lookups {0};
+    size_t levels {0}; //  Branches taken going down trees
+    size_t splits {0}; //  Nodes divided by inserts
+  };
+
+  ///  Letters could be used as a direct index of 256 slots table
+  template <typename T> inline constexpr bool byte_letter {sizeof(T) == 1 && std::is_integral_v<T>};
+
+  ///  Small branches set - keys are sorted and kept inline
+  template <typename T, size_t N> struct SmallBranches {
+    T keys[N] {};
+    node_id nodes[N] {};
+  };
+  ///  Up to 48 branches for single byte letters, index keeps slot number + 1 for every letter
+  struct Branches48 {
+    Branches48 () {std::fill(std::begin(nodes), std::end(nodes), no_node);}
+    std::uint8_t index[256] {};
+    node_id nodes[48];
+  };
+  ///  Direct table of branches for single byte letters
+  struct Branches256 {
+    Branches256 () {std::fill(std::begin(nodes), std::end(nodes), no_node);}
+    node_id nodes[256];
+  };
+  ///  Unlimited sorted branches set for wide letters
+  template <typename T, typename Alloc = std::allocator<T>> struct SortedBranches {
+    vector<T, Alloc> keys;
+    vector<node_id, typename std::allocator_traits<Alloc>::template rebind_alloc<node_id>> nodes;
+
+    SortedBranches() = default;
+    explicit SortedBranches(const Alloc& alloc) : keys(alloc), nodes(alloc) {}
+  };
+
+  ///  Allocator of an other value type
+  template <typename Alloc, typename U> using Rebind = typename std::allocator_traits<Alloc>::template rebind_alloc<U>;
+
+  ///  Slots of one kind with reuse of released ones. Slots owning memory (sorted sets) get the pool allocator
+  template <typename S, typename Alloc = std::allocator<S>> struct SlotPool {
+    vector<S, Rebind<Alloc, S>> slots;
+    vector<std::uint32_t, Rebind<Alloc, std::uint32_t>> released;
+
+    SlotPool() = default;
+    explicit SlotPool(const Alloc& alloc) : slots(alloc), released(alloc) {}
+
+    std::uint32_t make() {
+      if (released.empty()) {
+        if constexpr (std::is_constructible_v<S, const Alloc&>) {
+          slots.emplace_back(slots.get_allocator());
+        } else {
+          slots.emplace_back();
+        }
+        return static_cast<std::uint32_t>(slots.size() - 1);
+      }
+      std::uint32_t slot {released.back()};
+      released.pop_back();
+      if constexpr (std::is_constructible_v<S, const Alloc&>) {
+        slots[slot].keys.clear();
+        slots[slot].nodes.clear();
+      } else {
+        slots[slot] = S{};
+      }
+      return slot;
+    }
+    void release(std::uint32_t slot) {released.push_back(slot);}
+    void clear() noexcept {
+      slots.clear();
+      released.clear();
+    }
+  };
 
+  ///  Hint a cache to load memory, which will be read soon
+  inline void prefetchLine(const void* ptr) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(ptr);
+#endif
+  }
+
+  ///  Index of a key in 16 keys array or -1, integral keys are compared all at once with SSE2
+  template <typename T> int findKey16(const T (&keys)[16], const T& key, std::uint32_t count) noexcept {
+#if defined(__SSE2__)
+    if constexpr (std::is_integral_v<T> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4)) {
+      auto load = [&keys](size_t pos) {return _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + pos));};
+      __m128i cmp;
+      if constexpr (sizeof(T) == 1) {
+        cmp = _mm_cmpeq_epi8(load(0), _mm_set1_epi8(static_cast<char>(key)));
+      } else if constexpr (sizeof(T) == 2) {
+        __m128i needle {_mm_set1_epi16(static_cast<short>(key))};
+        cmp = _mm_packs_epi16(_mm_cmpeq_epi16(load(0), needle), _mm_cmpeq_epi16(load(8), needle));
+      } else {
+        __m128i needle {_mm_set1_epi32(static_cast<int>(key))};
+        cmp = _mm_packs_epi16(_mm_packs_epi32(_mm_cmpeq_epi32(load(0), needle), _mm_cmpeq_epi32(load(4), needle)),
+                              _mm_packs_epi32(_mm_cmpeq_epi32(load(8), needle), _mm_cmpeq_epi32(load(12), needle)));
+      }
+      unsigned mask {static_cast<unsigned>(_mm_movemask_epi8(cmp)) & ((1u << count) - 1)};
+      return mask ? std::countr_zero(mask) : -1;
+    }
+#endif
+    for (std::uint32_t pos = 0; pos < count; ++pos) {
+      if (keys[pos] == key) {
+        return static_cast<int>(pos);
+      }
+    }
+    return -1;
+  }
+
+  ///  Equal leading letters of two arrays of size letters, checked by blocks. Letters of any type are left to a
+  ///  letter by letter loop
+  template <typename T> struct PrefixKernel {
+    static size_t equalBlocks(const T*, const T*, size_t) noexcept {return 0;}
+  };
+  ///  Integral letters are equal when their bytes are, so blocks of 32 (AVX2) and 16 (SSE2) bytes are compared at once
+  template <typename T> requires (std::is_integral_v<T> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4))
+  struct PrefixKernel<T> {
+    static size_t equalBlocks([[maybe_unused]] const T* left, [[maybe_unused]] const T* right, [[maybe_unused]] size_t size) noexcept {
+      [[maybe_unused]] const size_t bytes {size * sizeof(T)};
+      [[maybe_unused]] const auto* left_bytes {reinterpret_cast<const char*>(left)};
+      [[maybe_unused]] const auto* right_bytes {reinterpret_cast<const char*>(right)};
+      size_t pos {0};
+#if defined(__AVX2__)
+      for (; pos + 32 <= bytes; pos += 32) {
+        __m256i cmp {_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(left_bytes + pos)),
+                                       _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right_bytes + pos)))};
+        auto diff {~static_cast<std::uint32_t>(_mm256_movemask_epi8(cmp))};
+        if (diff) {
+          return (pos + static_cast<size_t>(std::countr_zero(diff))) / sizeof(T);
+        }
+      }
+#endif
+#if defined(__SSE2__)
+      for (; pos + 16 <= bytes; pos += 16) {
+        __m128i cmp {_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(left_bytes + pos)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(right_bytes + pos)))};
+        auto diff {~static_cast<std::uint32_t>(_mm_movemask_epi8(cmp)) & 0xffffu};
+        if (diff) {
+          return (pos + static_cast<size_t>(std::countr_zero(diff))) / sizeof(T);
+        }
+      }
+#endif
+      return pos / sizeof(T);
+    }
+  };
+  ///  Length of a common prefix of a label and a word - every label comparison of the library goes here.
+  ///  Blocks are compared by PrefixKernel, a tail (and all letters in a constant evaluation) one by one.
+  ///  Letters of other traits are compared by keys, one by one
+  template <typename T, typename Traits = LetterTraits<T>> constexpr size_t commonPrefix(span<const T> left, span<const T> right) noexcept {
+    const size_t size {std::min(left.size(), right.size())};
+    size_t pos {0};
+    if constexpr (plain_traits<Traits, T>) {
+      if (!std::is_constant_evaluated()) {
+        pos = PrefixKernel<T>::equalBlocks(left.data(), right.data(), size);
+      }
+      for (; pos < size && left[pos] == right[pos]; ++pos) {}
+    } else {
+      for (; pos < size && Traits::key(left[pos]) == Traits::key(right[pos]); ++pos) {}
+    }
+    return pos;
+  }
+  ///  Letter traits of a nodes storage, letters of a storage without traits_type are compared as they are
+  template <typename Store, typename T> struct StoreTraits {using type = LetterTraits<T>;};
+  template <typename Store, typename T> requires requires {typename Store::traits_type;} struct StoreTraits<Store, T> {
+    using type = typename Store::traits_type;
+  };
+  template <typename Store, typename T> using store_traits = typename StoreTraits<Store, T>::type;
+
+  ///  Tree node. Nodes live in a NodeArena and refer to their label and to each other by 32-bit indices
   template <typename T> struct TreeNode {
-    TreeNode (unique_ptr<vector<T>> letters) : letters{std::move(letters)}{}
-    TreeNode (const vector<T> &&letters) : letters{make_unique<vector<T>>(std::move(letters))}{}
-    TreeNode (const vector<T> &&letters, vector<T> &&post_letters) : letters{make_unique<vector<T>>(std::move(letters))}, postfix_tree{make_unique<RadixTree<T>>(std::move(post_letters))}{}
-    TreeNode (const vector<T>&& letters, unique_ptr<RadixTree<T>> postfix_tree) : letters{make_unique<vector<T>>(std::move(letters))}, postfix_tree{std::move(postfix_tree)}{}
-    TreeNode (const vector<T>&& letters, unique_ptr<unordered_map<T, unique_ptr<TreeNode<T>>>> branch, unique_ptr<RadixTree<T>> postfix_tree) :
-      letters{make_unique<vector<T>>(std::move(letters))}, main_branches{std::move(branch)}, postfix_tree{std::move(postfix_tree)}{}
-    TreeNode (unique_ptr<vector<T>> letters, unique_ptr<unordered_map<T, unique_ptr<TreeNode<T>>>> branch) : letters{std::move(letters)}, main_branches{std::move(branch)}{}
-    TreeNode (unique_ptr<vector<T>> letters, unique_ptr<unordered_map<T, unique_ptr<TreeNode<T>>>> branch, unique_ptr<RadixTree<T>> postfix_tree) :
-      letters{std::move(letters)}, main_branches{std::move(branch)}, postfix_tree{std::move(postfix_tree)}{}
-    TreeNode (unique_ptr<vector<T>> letters, unique_ptr<vector<T>> post_letters, unique_ptr<unordered_map<T, unique_ptr<TreeNode<T>>>> branch) :
-      letters{std::move(letters)}, main_branches{std::move(branch)}, postfix_tree{std::move(postfix_tree)}{postfix_tree = make_unique<RadixTree<T>>(std::move(post_letters));}
-    TreeNode (const vector<T>&& letters, vector<T>&& post_letters, unique_ptr<unordered_map<T, unique_ptr<TreeNode<T>>>> branch) :
-      main_branches{std::move(branch)}, postfix_tree{std::move(postfix_tree)}{this->postfix_tree = make_unique<RadixTree<T>>(std::move(post_letters)); this->letters = make_unique<vector<T>>(letters);}
-
-
-    unique_ptr<vector<T>> letters;
-    unique_ptr<unordered_map<T, unique_ptr<TreeNode<T>>>> main_branches; // Branches to different letters
-    unique_ptr<RadixTree<T>> postfix_tree; //  Branch to second word's part (postfix one)
+    std::uint32_t letters_pos {0}; //  Label position in the arena letters pool
+    std::uint32_t letters_len {0}; //  Label size
+    std::uint32_t main_branches {0}; // Branches to different letters - slot of a branches set of branches_kind
+    std::uint32_t branches_count {0}; // Number of branches
+    node_id postfix_tree {no_node}; //  Branch to second word's part (postfix one) - root node of a postfix tree
+    std::uint32_t items {0}; //  Words ending in the node subtree, postfix trees included
+    std::uint32_t value {no_node}; //  Slot of a word payload in a map values pool
+    T key {}; //  First label letter - branch key in the parent node
+    BranchKind branches_kind {BranchKind::none};
+    bool word {false}; //  Node is an end of an inserted word
   };
 
-  ///  Radix tree to store commands - a dictionary, as a matter of fact
-  template <typename T> class RadixTree {
-    protected :
-      unique_ptr<unordered_map<T, unique_ptr<TreeNode<T>>>> root_branches;
-      //  Find a node of a tree with word
-      pair<pair<size_t, size_t>, TreeNode<T>*> goTree(TreeNode<T>* root, vector<T> &&word) const noexcept {
-        size_t vec_count {0};
-        size_t total_count {0};
+  ///  Storage for all nodes of a tree and of its postfix trees. Nodes are bump allocated in fixed size blocks
+  ///  and never move, labels of all nodes are kept in one shared letters pool. Whole storage is released at once.
+  ///  Node branches are adaptive sets (ART like) - small sorted arrays growing to direct tables as branches added.
+  ///  All memory (blocks, letters, branches sets) is taken from Alloc
+  template <typename T, typename Alloc = std::allocator<T>, typename Traits = LetterTraits<T>> class NodeArena {
+    private :
+      static constexpr size_t block_bits {10};
+      static constexpr size_t block_size {size_t{1} << block_bits};
+      using NodeAlloc = Rebind<Alloc, TreeNode<T>>;
+      //  Destroys and returns a block to the allocator it came from
+      struct BlockDeleter {
+        std::optional<NodeAlloc> alloc;
 
-        //  Going down tree
-        while (!word.empty()) {
+        BlockDeleter() = default;
+        explicit BlockDeleter(const NodeAlloc& alloc) : alloc{alloc} {}
+        BlockDeleter(const BlockDeleter&) = default;
+        //  Some allocators (polymorphic) are not assignable
+        BlockDeleter& operator= (const BlockDeleter& other) {
+          alloc.reset();
+          if (other.alloc) {
+            alloc.emplace(*other.alloc);
+          }
+          return *this;
+        }
+        void operator() (TreeNode<T>* block) noexcept {
+          std::destroy_n(block, block_size);
+          std::allocator_traits<NodeAlloc>::deallocate(*alloc, block, block_size);
+        }
+      };
+      using Block = unique_ptr<TreeNode<T>[], BlockDeleter>;
+      vector<Block, Rebind<Alloc, Block>> blocks;
+      vector<T, Alloc> letters_pool;
+      node_id nodes_count {0};
+      vector<node_id, Rebind<Alloc, node_id>> released_nodes; //  Erased nodes, reused by make
+      SlotPool<SmallBranches<T, 4>, Alloc> branches4;
+      SlotPool<SmallBranches<T, 16>, Alloc> branches16;
+      SlotPool<Branches48, Alloc> branches48;
+      SlotPool<Branches256, Alloc> branches256;
+      SlotPool<SortedBranches<T, Alloc>, Alloc> branches_sorted;
+      CLIDICT_STAT(mutable size_t descents {0};)
 
-          //  Check how many letters in new word are equal in in letters of existing one
-          for (vec_count = 0; vec_count < word.size(); ++vec_count) {
-            if (vec_count >= root->letters->size() - 1) {
-              break;
-            }
-            if (word.at(vec_count) != root->letters->at(vec_count)) {
-              break;
-            }
+      static std::uint8_t byteIndex(const T& key) noexcept {return static_cast<std::uint8_t>(key);}
+      //  Index of a step of a walk over all single byte keys in keyLess order - signed letters start from 0x80
+      static std::uint8_t byteStep(unsigned step) noexcept {
+        constexpr bool unsigned_order {keyLess(T{}, static_cast<T>(-1))};
+        return static_cast<std::uint8_t>(unsigned_order ? step : step ^ 0x80u);
+      }
+      //  Put a key to a sorted inline array
+      template <size_t N> static void insertSorted(SmallBranches<T, N>& set, std::uint32_t count, const T& key, node_id branch) noexcept {
+        std::uint32_t pos {count};
+        for (; pos > 0 && keyLess(key, set.keys[pos - 1]); --pos) {
+          set.keys[pos] = set.keys[pos - 1];
+          set.nodes[pos] = set.nodes[pos - 1];
+        }
+        set.keys[pos] = key;
+        set.nodes[pos] = branch;
+      }
+      //  Next node at the storage end
+      node_id bump() {
+        if (nodes_count == blocks.size() * block_size) {
+          NodeAlloc node_alloc {letters_pool.get_allocator()};
+          TreeNode<T>* block {std::allocator_traits<NodeAlloc>::allocate(node_alloc, block_size)};
+          std::uninitialized_value_construct_n(block, block_size);
+          blocks.emplace_back(block, BlockDeleter{node_alloc});
+        }
+        return nodes_count++;
+      }
+      //  Copy all sets of an other pool to the end of a pool, node ids in sets are shifted by offset.
+      //  Returns a slot of a first copied set
+      template <typename Pool> static std::uint32_t appendSlots(Pool& pool, const Pool& other, node_id offset) {
+        auto base {static_cast<std::uint32_t>(pool.slots.size())};
+        auto shift = [offset](node_id& id) {
+          if (id != no_node) {
+            id += offset;
+          }
+        };
+        for (const auto& set : other.slots) {
+          if constexpr (std::is_constructible_v<std::remove_cvref_t<decltype(set)>, const Alloc&>) {
+            //  Sets owning memory take it from the pool allocator
+            auto& copy {pool.slots.emplace_back(pool.slots.get_allocator())};
+            copy.keys.assign(set.keys.begin(), set.keys.end());
+            copy.nodes.assign(set.nodes.begin(), set.nodes.end());
+            ranges::for_each(copy.nodes, shift);
+          } else {
+            ranges::for_each(pool.slots.emplace_back(set).nodes, shift);
           }
+        }
+        for (std::uint32_t slot : other.released) {
+          pool.released.push_back(base + slot);
+        }
+        return base;
+      }
+    public :
+      using traits_type = Traits;
 
-          //  Check if words are same
-          if (vec_count == word.size()) {
+      explicit NodeArena(const Alloc& alloc = Alloc()) : blocks(alloc), letters_pool(alloc), released_nodes(alloc),
+        branches4(alloc), branches16(alloc), branches48(alloc), branches256(alloc), branches_sorted(alloc) {}
+      NodeArena(NodeArena&&) = default;
+      NodeArena& operator= (NodeArena&&) = default;
+      ~NodeArena() = default;
+      ///  Allocator all memory of a storage is taken from
+      Alloc get_allocator() const noexcept {return letters_pool.get_allocator();}
+      ///  Allocate a new node with a copy of a label
+      node_id make(span<const T> letters) {
+        node_id id;
+        if (!released_nodes.empty()) {
+          id = released_nodes.back();
+          released_nodes.pop_back();
+        } else {
+          id = bump();
+        }
+        TreeNode<T>& node {(*this)[id]};
+        node = TreeNode<T>{};
+        node.letters_pos = static_cast<std::uint32_t>(letters_pool.size());
+        node.letters_len = static_cast<std::uint32_t>(letters.size());
+        if (!letters.empty()) {
+          node.key = letters.front();
+          letters_pool.insert(letters_pool.end(), letters.begin(), letters.end());
+        }
+        return id;
+      }
+      TreeNode<T>& operator[](node_id id) noexcept {return blocks[id >> block_bits][id & (block_size - 1)];}
+      const TreeNode<T>& operator[](node_id id) const noexcept {return blocks[id >> block_bits][id & (block_size - 1)];}
+      ///  Label of a node
+      span<const T> letters(const TreeNode<T>& node) const noexcept {return {letters_pool.data() + node.letters_pos, node.letters_len};}
+      span<const T> letters(node_id id) const noexcept {return letters((*this)[id]);}
+      ///  Branch of a node by first letter
+      node_id branch(node_id id, const T& key) const noexcept {
+        CLIDICT_STAT(++descents;)
+        return findBranch((*this)[id], key);
+      }
+      ///  Root of a node postfix tree
+      node_id postfix(node_id id) const noexcept {return (*this)[id].postfix_tree;}
+      ///  Node is an end of an inserted word
+      bool word(node_id id) const noexcept {return (*this)[id].word;}
+      ///  Words ending in a node subtree, postfix trees included
+      std::uint32_t items(node_id id) const noexcept {return (*this)[id].items;}
+      ///  Hint a cache to load a node
+      void prefetch(node_id id) const noexcept {prefetchLine(&(*this)[id]);}
+      ///  Hint a cache to load a node label and branches set, the node itself should be in a cache already
+      void prefetchBody(node_id id) const noexcept {
+        const TreeNode<T>& node {(*this)[id]};
+        prefetchLine(letters_pool.data() + node.letters_pos);
+        switch (node.branches_kind) {
+          case BranchKind::none :
             break;
+          case BranchKind::node4 :
+            prefetchLine(&branches4.slots[node.main_branches]);
+            break;
+          case BranchKind::node16 :
+            prefetchLine(&branches16.slots[node.main_branches]);
+            break;
+          case BranchKind::node48 :
+            prefetchLine(&branches48.slots[node.main_branches]);
+            break;
+          case BranchKind::node256 :
+            prefetchLine(&branches256.slots[node.main_branches]);
+            break;
+          case BranchKind::sorted :
+            prefetchLine(branches_sorted.slots[node.main_branches].keys.data());
+            break;
+        }
+      }
+      ///  Number of allocated nodes
+      size_t size() const noexcept {return nodes_count;}
+      ///  Number of branch lookups, zero unless built with CLIDICT_STATS
+      size_t branchLookups() const noexcept {
+#if defined(CLIDICT_STATS)
+        return descents;
+#else
+        return 0;
+#endif
+      }
+      ///  Bytes reserved for labels, branches sets and nodes
+      void memory(TreeStats& stats) const noexcept {
+        auto pool_bytes = [](const auto& pool) {return pool.slots.capacity() * sizeof(pool.slots.front());};
+        stats.letters_bytes = letters_pool.capacity() * sizeof(T);
+        stats.branches_bytes = pool_bytes(branches4) + pool_bytes(branches16) + pool_bytes(branches48) + pool_bytes(branches256) +
+                               pool_bytes(branches_sorted);
+        for (const auto& set : branches_sorted.slots) {
+          stats.branches_bytes += set.keys.capacity() * sizeof(T) + set.nodes.capacity() * sizeof(node_id);
+        }
+        stats.nodes_bytes = blocks.size() * block_size * sizeof(TreeNode<T>);
+      }
+      ///  Release all nodes and labels
+      void clear() noexcept {
+        blocks.clear();
+        letters_pool.clear();
+        nodes_count = 0;
+        released_nodes.clear();
+        branches4.clear();
+        branches16.clear();
+        branches48.clear();
+        branches256.clear();
+        branches_sorted.clear();
+      }
+      ///  Copy all nodes of an other storage to the end of this one, ids of copied nodes are shifted by the returned
+      ///  offset. Lets trees built apart (by threads) be joined
+      node_id append(const NodeArena& other) {
+        const node_id offset {nodes_count};
+        const auto letters_offset {static_cast<std::uint32_t>(letters_pool.size())};
+        letters_pool.insert(letters_pool.end(), other.letters_pool.begin(), other.letters_pool.end());
+        const std::uint32_t slot_offsets[] {0, appendSlots(branches4, other.branches4, offset), appendSlots(branches16, other.branches16, offset),
+                                            appendSlots(branches48, other.branches48, offset), appendSlots(branches256, other.branches256, offset),
+                                            appendSlots(branches_sorted, other.branches_sorted, offset)};
+        for (node_id id = 0; id < other.nodes_count; ++id) {
+          TreeNode<T>& node {(*this)[bump()]};
+          node = other[id];
+          node.letters_pos += letters_offset;
+          node.main_branches += slot_offsets[static_cast<size_t>(node.branches_kind)];
+          if (node.postfix_tree != no_node) {
+            node.postfix_tree += offset;
           }
-
-          //  There is a difference, case to modify a tree
-          if (vec_count != root->letters->size() - 1) {
+        }
+        for (node_id id : other.released_nodes) {
+          released_nodes.push_back(id + offset);
+        }
+        return offset;
+      }
+      ///  Give a node a new label, an old one stays in the letters pool till a compaction
+      void relabel(node_id id, span<const T> letters) {
+        vector<T> label {letters.begin(), letters.end()}; //  Letters could be in the pool itself
+        TreeNode<T>& node {(*this)[id]};
+        node.letters_pos = static_cast<std::uint32_t>(letters_pool.size());
+        node.letters_len = static_cast<std::uint32_t>(label.size());
+        letters_pool.insert(letters_pool.end(), label.begin(), label.end());
+      }
+      ///  Release a branches set of a node, the node has no branches after it
+      void freeBranches(TreeNode<T>& node) noexcept {
+        switch (node.branches_kind) {
+          case BranchKind::none :
+            break;
+          case BranchKind::node4 :
+            branches4.release(node.main_branches);
+            break;
+          case BranchKind::node16 :
+            branches16.release(node.main_branches);
+            break;
+          case BranchKind::node48 :
+            branches48.release(node.main_branches);
+            break;
+          case BranchKind::node256 :
+            branches256.release(node.main_branches);
+            break;
+          case BranchKind::sorted :
+            branches_sorted.release(node.main_branches);
+            break;
+        }
+        node.branches_kind = BranchKind::none;
+        node.branches_count = 0;
+      }
+      ///  Release an erased node with its branches set, its label stays in the letters pool till a compaction
+      void release(node_id id) {
+        freeBranches((*this)[id]);
+        released_nodes.push_back(id);
+      }
+      ///  Remove a branch of a node by its key, an empty branches set is released
+      void removeBranch(node_id node_idx, const T& letter) noexcept {
+        TreeNode<T>& node {(*this)[node_idx]};
+        const T key {Traits::key(letter)};
+        auto remove_small = [&node, &key](auto& set) {
+          std::uint32_t pos {0};
+          while (pos < node.branches_count && set.keys[pos] != key) {
+            ++pos;
+          }
+          if (pos == node.branches_count) {
+            return false;
+          }
+          std::copy(set.keys + pos + 1, set.keys + node.branches_count, set.keys + pos);
+          std::copy(set.nodes + pos + 1, set.nodes + node.branches_count, set.nodes + pos);
+          return true;
+        };
+        bool removed {false};
+        switch (node.branches_kind) {
+          case BranchKind::none :
+            break;
+          case BranchKind::node4 :
+            removed = remove_small(branches4.slots[node.main_branches]);
+            break;
+          case BranchKind::node16 :
+            removed = remove_small(branches16.slots[node.main_branches]);
+            break;
+          case BranchKind::node48 : {
+            auto& set {branches48.slots[node.main_branches]};
+            if (std::uint8_t slot {set.index[byteIndex(key)]}) {
+              set.nodes[slot - 1] = no_node;
+              set.index[byteIndex(key)] = 0;
+              removed = true;
+            }
             break;
           }
-
-          //  Going tree down (next level)
-          if (total_count) {
-            ++total_count;
+          case BranchKind::node256 : {
+            auto& branch {branches256.slots[node.main_branches].nodes[byteIndex(key)]};
+            removed = branch != no_node;
+            branch = no_node;
+            break;
           }
-          total_count += vec_count;
-          word.erase(word.begin(), word.begin() + vec_count + 1);
-          if (root->main_branches && root->main_branches->contains(word.front())) {
-            root = root->main_branches->at(word.front()).get();
-          } else {
+          case BranchKind::sorted : {
+            auto& set {branches_sorted.slots[node.main_branches]};
+            auto key_it {std::lower_bound(set.keys.begin(), set.keys.end(), key, keyLess<T>)};
+            if (key_it != set.keys.end() && *key_it == key) {
+              set.nodes.erase(set.nodes.begin() + (key_it - set.keys.begin()));
+              set.keys.erase(key_it);
+              removed = true;
+            }
             break;
           }
         }
-        if (total_count < vec_count) {
-          total_count = vec_count;
+        if (removed && --node.branches_count == 0) {
+          freeBranches(node);
         }
-        return std::make_pair(std::make_pair(total_count - vec_count, vec_count), root);
       }
-   
-      public :
-        ///  Creating an empty container
-        RadixTree () : root_branches{make_unique<unordered_map<T, unique_ptr<TreeNode<T>>>>()}{}
-        ///  Creating a container with a single commands instance
-        RadixTree (vector<T> &&letters) : root_branches{make_unique<unordered_map<T, unique_ptr<TreeNode<T>>>>()}{ins(std::move(letters));}
-        ///  Creating a container with a list of instances
-        RadixTree (std::initializer_list<vector<T>> init): RadixTree() {ranges::for_each(init, [this](auto word){ins(std::move(word));});}
-        ~RadixTree () = default;
-        ///  Insert a new item to container
-        bool ins(vector<T> &&word) noexcept {
-          bool ret{false};
-          TreeNode<T>* tree_node = nullptr;
-          size_t word_last_pos {word.size() - 1};
-          auto new_word = make_unique<vector<T>>();
-          unique_ptr<vector<T>> new_branch_word;
-          auto old_branch_word = make_unique<vector<T>>();
-          size_t smallest_word {0};
-          size_t vec_count {0};
-
-          if (word.empty()) {
-            return ret;
-          }
-          //  First insert to empty tree
-          if (!root_branches->contains(word.front())) {
-            T word_front {word.front()};
-            root_branches->emplace(std::move(word_front), make_unique<TreeNode<T>>(std::move(word)));
-            return true;
-          } else {
-            TreeNode<T>* root_branch = root_branches->at(word.front()).get();
-            auto tree_pos = goTree(root_branch, vector<T>(word));
-            vec_count = tree_pos.first.second;
-            tree_node = tree_pos.second;
-
-            //  Check if word already exists
-            if (tree_node->letters && *tree_node->letters == word) {
-              return ret;
-            }
-              word.erase(word.begin(), word.begin() + tree_pos.first.first);
-              word_last_pos = word.size() - 1;
-            }
-
-             //  Probably new branch. Could be 3 cases :
-             //  absolutely same - do nothing (out of scope)
-             //  just add new branch if new word first symbols are same with all existing
-             //  partially similar - a few symbols are same but there is a difference : by difference  creating new nodes (dividing existing one into tow part)
-             if (tree_node && tree_node->letters) {
-               smallest_word = std::min(word_last_pos, tree_node->letters->size() - 1);
-               if (!word.empty()) {
-                 size_t word_count = 0;
-                 for (auto &count : *tree_node->letters) {
-                   if (word_count == smallest_word + 1) {
-                     break;
-                  }
-                  if (count != word.at(word_count)) {
-                    break;
-                  }
-                  new_word->push_back(count);
-                  ++word_count;
-                }
+
+      ///  Find a branch of a node by first letter
+      node_id findBranch(const TreeNode<T>& node, const T& letter) const noexcept {
+        const T key {Traits::key(letter)};
+        switch (node.branches_kind) {
+          case BranchKind::none :
+            return no_node;
+          case BranchKind::node4 : {
+            const auto& set {branches4.slots[node.main_branches]};
+            for (std::uint32_t pos = 0; pos < node.branches_count; ++pos) {
+              if (set.keys[pos] == key) {
+                return set.nodes[pos];
               }
             }
+            return no_node;
+          }
+          case BranchKind::node16 : {
+            const auto& set {branches16.slots[node.main_branches]};
+            int pos {findKey16(set.keys, key, node.branches_count)};
+            return pos < 0 ? no_node : set.nodes[pos];
+          }
+          case BranchKind::node48 : {
+            const auto& set {branches48.slots[node.main_branches]};
+            std::uint8_t slot {set.index[byteIndex(key)]};
+            return slot ? set.nodes[slot - 1] : no_node;
+          }
+          case BranchKind::node256 :
+            return branches256.slots[node.main_branches].nodes[byteIndex(key)];
+          case BranchKind::sorted : {
+            const auto& set {branches_sorted.slots[node.main_branches]};
+            auto key_it {std::lower_bound(set.keys.begin(), set.keys.end(), key, keyLess<T>)};
+            return key_it != set.keys.end() && *key_it == key ? set.nodes[key_it - set.keys.begin()] : no_node;
+          }
+        }
+        return no_node;
+      }
+      ///  Add a new branch to a node, branches set grows to a bigger kind when it is full
+      void addBranch(node_id node_idx, node_id branch) {
+        TreeNode<T>& node {(*this)[node_idx]};
+        const T key {Traits::key((*this)[branch].key)};
+        std::uint32_t count {node.branches_count};
 
-            vector<T> word_rest {word.begin() + new_word->size(), word.end()};
-            // Just add a rest of a word to a new branch (case #2)
-            if (new_word->size() == tree_node->letters->size()) {
-              auto key = word_rest.front();
-              if (!tree_node->main_branches) {
-                tree_node->main_branches = make_unique<unordered_map<T, unique_ptr<TreeNode<T>>>>();
+        switch (node.branches_kind) {
+          case BranchKind::none : {
+            std::uint32_t slot {branches4.make()};
+            insertSorted(branches4.slots[slot], 0, key, branch);
+            node.main_branches = slot;
+            node.branches_kind = BranchKind::node4;
+            break;
+          }
+          case BranchKind::node4 : {
+            if (count < 4) {
+              insertSorted(branches4.slots[node.main_branches], count, key, branch);
+              break;
+            }
+            std::uint32_t slot {branches16.make()};
+            auto& set {branches16.slots[slot]};
+            const auto& old_set {branches4.slots[node.main_branches]};
+            std::copy_n(old_set.keys, count, set.keys);
+            std::copy_n(old_set.nodes, count, set.nodes);
+            insertSorted(set, count, key, branch);
+            branches4.release(node.main_branches);
+            node.main_branches = slot;
+            node.branches_kind = BranchKind::node16;
+            break;
+          }
+          case BranchKind::node16 : {
+            if (count < 16) {
+              insertSorted(branches16.slots[node.main_branches], count, key, branch);
+              break;
+            }
+            const SmallBranches<T, 16> old_set {branches16.slots[node.main_branches]};
+            branches16.release(node.main_branches);
+            if constexpr (byte_letter<T>) {
+              std::uint32_t slot {branches48.make()};
+              auto& set {branches48.slots[slot]};
+              for (std::uint32_t pos = 0; pos < count; ++pos) {
+                set.index[byteIndex(old_set.keys[pos])] = static_cast<std::uint8_t>(pos + 1);
+                set.nodes[pos] = old_set.nodes[pos];
               }
-              tree_node->main_branches->emplace(key, make_unique<TreeNode<T>>(std::move(word_rest)));
-              return ret = true;
+              set.index[byteIndex(key)] = static_cast<std::uint8_t>(count + 1);
+              set.nodes[count] = branch;
+              node.main_branches = slot;
+              node.branches_kind = BranchKind::node48;
+            } else {
+              std::uint32_t slot {branches_sorted.make()};
+              auto& set {branches_sorted.slots[slot]};
+              set.keys.assign(old_set.keys, old_set.keys + count);
+              set.nodes.assign(old_set.nodes, old_set.nodes + count);
+              auto key_it {std::lower_bound(set.keys.begin(), set.keys.end(), key, keyLess<T>)};
+              set.nodes.insert(set.nodes.begin() + (key_it - set.keys.begin()), branch);
+              set.keys.insert(key_it, key);
+              node.main_branches = slot;
+              node.branches_kind = BranchKind::sorted;
             }
-
-            //  Comparison was terminated before end of words, there is a difference
-            //  between existing and new word. Case to reorder tree (#3).
-            if (vec_count <= word.size() /*&& vec_count > 1*/) {
-              new_word.swap(tree_node->letters);
-              if (!word_rest.empty()) {
-                new_branch_word = make_unique<vector<T>>();
-                ranges::move(word_rest, std::back_inserter(*new_branch_word));
+            break;
+          }
+          case BranchKind::node48 : {
+            auto& set {branches48.slots[node.main_branches]};
+            if (count < 48) {
+              std::uint32_t pos {static_cast<std::uint32_t>(std::find(std::begin(set.nodes), std::end(set.nodes), no_node) - std::begin(set.nodes))};
+              set.index[byteIndex(key)] = static_cast<std::uint8_t>(pos + 1);
+              set.nodes[pos] = branch;
+              break;
+            }
+            std::uint32_t slot {branches256.make()};
+            auto& big_set {branches256.slots[slot]};
+            for (size_t letter = 0; letter < 256; ++letter) {
+              if (set.index[letter]) {
+                big_set.nodes[letter] = set.nodes[set.index[letter] - 1];
               }
-              std::move(std::make_move_iterator(new_word->begin() + vec_count), std::make_move_iterator(new_word->end()), std::back_inserter(*old_branch_word));
-              if (!old_branch_word->empty()) {
-                auto old_word_key = old_branch_word->front();
-                auto old_word_node = make_unique<TreeNode<T>>(std::move(old_branch_word), std::move(tree_node->main_branches));
-                if (!tree_node->main_branches) {
-                  tree_node->main_branches = make_unique<unordered_map<T, unique_ptr<TreeNode<T>>>>();
+            }
+            big_set.nodes[byteIndex(key)] = branch;
+            branches48.release(node.main_branches);
+            node.main_branches = slot;
+            node.branches_kind = BranchKind::node256;
+            break;
+          }
+          case BranchKind::node256 :
+            branches256.slots[node.main_branches].nodes[byteIndex(key)] = branch;
+            break;
+          case BranchKind::sorted : {
+            auto& set {branches_sorted.slots[node.main_branches]};
+            auto key_it {std::lower_bound(set.keys.begin(), set.keys.end(), key, keyLess<T>)};
+            set.nodes.insert(set.nodes.begin() + (key_it - set.keys.begin()), branch);
+            set.keys.insert(key_it, key);
+            break;
+          }
+        }
+        ++node.branches_count;
+      }
+      template <typename F> void forBranches(node_id id, F&& fn) const {forBranches((*this)[id], std::forward<F>(fn));}
+      ///  Call fn(branch) for every branch of a node in order of keys
+      template <typename F> void forBranches(const TreeNode<T>& node, F&& fn) const {
+        switch (node.branches_kind) {
+          case BranchKind::none :
+            break;
+          case BranchKind::node4 :
+            std::for_each_n(branches4.slots[node.main_branches].nodes, node.branches_count, fn);
+            break;
+          case BranchKind::node16 :
+            std::for_each_n(branches16.slots[node.main_branches].nodes, node.branches_count, fn);
+            break;
+          case BranchKind::node48 :
+            if constexpr (byte_letter<T>) {
+              const auto& set {branches48.slots[node.main_branches]};
+              for (unsigned step = 0; step < 256; ++step) {
+                if (std::uint8_t slot {set.index[byteStep(step)]}) {
+                  fn(set.nodes[slot - 1]);
                 }
-                tree_node->main_branches->emplace(std::make_pair(old_word_key, std::move(old_word_node)));
               }
-              if (new_branch_word) {
-                auto new_word_key = new_branch_word->front();
-                auto new_word_node = make_unique<TreeNode<T>>(std::move(new_branch_word));
-                tree_node->main_branches->emplace(std::make_pair(new_word_key, std::move(new_word_node)));
+            }
+            break;
+          case BranchKind::node256 :
+            if constexpr (byte_letter<T>) {
+              const auto& set {branches256.slots[node.main_branches]};
+              for (unsigned step = 0; step < 256; ++step) {
+                if (node_id branch {set.nodes[byteStep(step)]}; branch != no_node) {
+                  fn(branch);
+                }
               }
             }
-            return ret;
+            break;
+          case BranchKind::sorted :
+            ranges::for_each(branches_sorted.slots[node.main_branches].nodes, fn);
+            break;
         }
-        ///  Get an item from container
-        [[nodiscard]] unique_ptr<vector<T>> get(vector<T> const &&word) const noexcept {
-          unique_ptr<vector<T>> ret;
+      }
+  };
 
-          //  Check data
-          if(word.empty()) {
-            return ret;
-          }
+  ///  Place in a tree where a word search stopped
+  struct TreePos {
+    node_id node; //  Last reached node
+    size_t depth {0}; //  Word letters before the node label
+    size_t matched {0}; //  Node label letters equal to the word
+    bool found {true}; //  All word letters are in a tree
+  };
 
-          if (root_branches && root_branches->contains(word.front())) {
-            auto node = goTree(root_branches->at(word.front()).get(), vector<T>(word));
-            if (node.second) {
-              ret = make_unique<vector<T>>(word.begin(), word.begin() + node.first.first);
-              ret->insert(ret->end(), node.second->letters->begin(), node.second->letters->end());
-            }
-          }
-          return ret;
-        }
+  ///  Find a node of a tree with word. Store is a nodes storage - letters(node) and branch(node, letter) give
+  ///  node label and a branch by first letter
+  template <typename T, typename Store> constexpr TreePos walkTree(const Store& store, node_id root, span<const T> word) noexcept {
+    TreePos pos {root};
+    size_t word_pos {0};
+
+    //  Going down tree
+    while (word_pos < word.size()) {
+      node_id branch {store.branch(pos.node, word[word_pos])};
+      if (branch == no_node) {
+        pos.found = false;
+        break;
+      }
+
+      //  Check how many letters in the word are equal to the node label
+      auto letters {store.letters(branch)};
+      pos = {branch, word_pos, commonPrefix<T, store_traits<Store, T>>(letters, word.subspan(word_pos))};
+      word_pos += pos.matched;
+
+      //  Word is over or differs in the middle of a label
+      if (pos.matched != letters.size()) {
+        pos.found = word_pos == word.size();
+        break;
+      }
+    }
+    return pos;
+  }
+  ///  Find a node where the word ends exactly
+  template <typename T, typename Store> constexpr node_id findWord(const Store& store, node_id root, span<const T> word) noexcept {
+    auto pos {walkTree(store, root, word)};
+    if (!pos.found || pos.node == root || pos.matched != store.letters(pos.node).size()) {
+      return no_node;
+    }
+    return pos.node;
+  }
+  ///  Add a word completion by a walk result to the end of ret, returns the last node
+  template <typename T, typename Store> node_id completePos(const Store& store, node_id root, span<const T> word, const TreePos& pos, vector<T>& ret) {
+    if (!pos.found || pos.node == root) {
+      return no_node;
+    }
+    auto letters {store.letters(pos.node)};
+    ret.insert(ret.end(), word.begin(), word.begin() + pos.depth);
+    ret.insert(ret.end(), letters.begin(), letters.end());
+    return pos.node;
+  }
+  ///  Add a word completion (word with a rest of a last node) to the end of ret, returns the last node
+  template <typename T, typename Store> node_id completeWord(const Store& store, node_id root, span<const T> word, vector<T>& ret) {
+    return completePos(store, root, word, walkTree(store, root, word), ret);
+  }
+
+  ///  Found word or item as spans over a looked up word and tree labels, no letter is copied. A word is typed
+  ///  letters and a last node label, a dictionary item adds a delimiter and the same two parts of a post part.
+  ///  A view is valid while the looked up word lives and the tree is not changed
+  template <typename T> struct WordView {
+    span<const T> typed;
+    span<const T> rest;
+    std::optional<T> delim {}; //  Item has a delimiter
+    span<const T> post_typed {};
+    span<const T> post_rest {};
+
+    ///  Number of letters
+    [[nodiscard]] size_t size() const noexcept {return typed.size() + rest.size() + (delim ? 1 + post_typed.size() + post_rest.size() : 0);}
+    ///  Write letters to an output iterator, returns an iterator past the last one
+    template <std::output_iterator<const T&> Out> Out copy(Out out) const {
+      out = ranges::copy(typed, std::move(out)).out;
+      out = ranges::copy(rest, std::move(out)).out;
+      if (delim) {
+        *out++ = *delim;
+        out = ranges::copy(post_typed, std::move(out)).out;
+        out = ranges::copy(post_rest, std::move(out)).out;
+      }
+      return out;
+    }
   };
-}
+  ///  Word completion as a view, see completePos
+  template <typename T, typename Store> std::optional<WordView<T>> viewPos(const Store& store, node_id root, span<const T> word, const TreePos& pos) noexcept {
+    if (!pos.found || pos.node == root) {
+      return std::nullopt;
+    }
+    return WordView<T>{word.first(pos.depth), store.letters(pos.node)};
+  }
+  ///  Word completion as a view, see completeWord
+  template <typename T, typename Store> std::optional<WordView<T>> viewWord(const Store& store, node_id root, span<const T> word) noexcept {
+    return viewPos(store, root, word, walkTree(store, root, word));
+  }
 
-namespace cli_dict {
-  template <typename T> using Leaf = radix_dict::TreeNode<T>;
-  template <typename T> using Node = radix_dict::RadixTree<T>;
+  ///  One walk of a batch - a root and a word in, the same result as walkTree gives out
+  template <typename T> struct BatchWalk {
+    node_id root;
+    span<const T> word;
+    TreePos pos {root};
+  };
+  ///  Walk many words at once. Walks are interleaved - a walk asks a cache for a next node and gives a way to other
+  ///  walks till the node memory comes. Store should give prefetch(node) for a node and prefetchBody(node) for its
+  ///  label and branches
+  template <typename T, typename Store> void walkTrees(const Store& store, span<BatchWalk<T>> walks) noexcept {
+    static constexpr size_t group_size {16};
+    struct Slot {
+      BatchWalk<T>* walk {nullptr};
+      size_t word_pos {0};
+      node_id next {no_node}; //  Branch to visit, its memory is asked already
+      bool body {false}; //  Label and branches of the branch are asked too
+    };
+    Slot group[group_size];
+    size_t next_walk {0};
 
-  ///  Container to store command dived by any kind of delimiters
-  template <typename T> class Dict : public Node<T> {
-    private :
-      T delim;
-      unique_ptr<unordered_map<T, unique_ptr<Leaf<T>>>> root;
-    public :
-      ///  Creating an empty dictionary container with a delimetr
-      explicit Dict (const T delim) : Node<T>() {this->delim = delim; root = make_unique<unordered_map<T, unique_ptr<Leaf<T>>>>();};
-      ///  Creating a dictionary container with a delimetr by a list of items
-      Dict (const T delim, std::initializer_list<vector<T>> init_lst) : Dict (delim) {
-        for (auto comm : init_lst) {
-          ins (std::move(comm));
+    //  Start a next walk in a slot from its root
+    auto start = [&](Slot& slot) {
+      slot.walk = nullptr;
+      while (next_walk < walks.size()) {
+        BatchWalk<T>& walk {walks[next_walk++]};
+        walk.pos = {walk.root};
+        if (!walk.word.empty()) {
+          store.prefetch(walk.root);
+          slot = {&walk, 0, walk.root, false};
+          return;
         }
       }
-      ///  Insert a new item to container
-      bool ins(vector<T> &&letters) noexcept {
-        bool ret {false};
-        vector<T> ins_word, existing_word;
-        vector<T> equal_str;
+    };
+    size_t active {0};
+    for (auto& slot : group) {
+      start(slot);
+      active += slot.walk != nullptr;
+    }
 
-        //  Check data
-        if (letters.empty()) {
-          return ret;
+    while (active) {
+      for (auto& slot : group) {
+        if (!slot.walk) {
+          continue;
         }
-
-        //  Divide string into pre and post parts
-        vector<T> pre_str, post_str;
-        if (auto delim_it {ranges::find(letters, delim)}; delim_it != letters.end()) {
-          std::move (std::make_move_iterator(delim_it + 1), std::make_move_iterator(letters.end()), std::back_inserter<vector<T>>(post_str));
-          std::move (std::make_move_iterator(letters.begin()), std::make_move_iterator(delim_it), std::back_inserter<vector<T>>(pre_str));
-        } else {
-          ranges::move(letters, std::back_inserter<vector<T>>(pre_str));
+        if (!slot.body) {
+          store.prefetchBody(slot.next);
+          slot.body = true;
+          continue;
         }
 
-        //  Find position to insert new string
-        if (auto key {pre_str.front()}; root->contains(key)) {
-          auto tree_position = Node<T>::goTree(root->at(key).get(), vector<T>(pre_str.begin(), pre_str.end()));
-          auto tree_node = tree_position.second;
-          pre_str.erase(pre_str.begin(), pre_str.begin() + tree_position.first.first);
-
-          //  Just add a new postfix part
-          if (pre_str == *tree_position.second->letters) {
-            if (!tree_position.second->postfix_tree) {
-              tree_position.second->postfix_tree = make_unique<Node<T>>(std::move(pre_str));
-              ret = true;
-            } else {
-              ret = tree_position.second->postfix_tree->ins(std::move(pre_str));
-            }
-            return ret;
+        //  Same step as walkTree does, a root label is not compared
+        BatchWalk<T>& walk {*slot.walk};
+        bool done {true};
+        if (slot.next != walk.root) {
+          auto letters {store.letters(slot.next)};
+          walk.pos = {slot.next, slot.word_pos, commonPrefix<T, store_traits<Store, T>>(letters, walk.word.subspan(slot.word_pos))};
+          slot.word_pos += walk.pos.matched;
+          if (walk.pos.matched != letters.size()) {
+            walk.pos.found = slot.word_pos == walk.word.size();
+            slot.word_pos = walk.word.size();
           }
-          size_t ex_count = 0;
-          for (auto count : pre_str) {
-            if (ex_count < tree_node->letters->size() && count == tree_node->letters->at(ex_count)) {
-              equal_str.push_back(count);
-            } else {
-              break;
-            }
-            ++ex_count;
+        }
+        if (slot.word_pos < walk.word.size()) {
+          node_id branch {store.branch(slot.next, walk.word[slot.word_pos])};
+          if (branch == no_node) {
+            walk.pos.found = false;
+          } else {
+            store.prefetch(branch);
+            slot.next = branch;
+            slot.body = false;
+            done = false;
           }
-          auto equal_str_cmp = tree_node->letters->size() <=> equal_str.size();
+        }
+        if (done) {
+          start(slot);
+          active -= slot.walk == nullptr;
+        }
+      }
+    }
+  }
 
-          //  Existing word is smaller then common words part - case to divide existing node to two branches
-          if (equal_str_cmp > 0) {
+  ///  Item found by a fuzzy lookup and its edit distance to a looked up word
+  template <typename T> struct FuzzyMatch {
+    vector<T> word;
+    size_t distance;
+  };
+  ///  Items within max_distance edits (Levenshtein) of a word, nearest first. A tree is walked with one DP row
+  ///  per label letter, a subtree is skipped once every value of a row is over max_distance. With a delimiter
+  ///  postfix trees are walked on after it, as Dict items are
+  template <typename T, typename Store> vector<FuzzyMatch<T>> fuzzyFind(const Store& store, node_id root, span<const T> word,
+                                                                        size_t max_distance, std::optional<T> delim = std::nullopt) {
+    using Traits = store_traits<Store, T>;
+    const size_t width {word.size() + 1};
+    vector<size_t> rows(width); //  Rows of all letters on a path, one after another
+    std::iota(rows.begin(), rows.end(), size_t{0});
+    vector<T> path;
+    vector<FuzzyMatch<T>> found;
 
-            //  Creating words part for new branch
-            vector<T> new_word_ins, old_word_ins;
-            std::copy(tree_node->letters->begin() + equal_str.size(), tree_node->letters->end(), std::back_inserter<vector<T>>(old_word_ins));
-            if (pre_str.size() > equal_str.size()) {
-              std::copy(pre_str.begin() + equal_str.size(), pre_str.end(), std::back_inserter<vector<T>>(new_word_ins));
-            }
+    //  Add a row for a next path letter, returns the smallest row value
+    auto push_letter = [&](const T& letter) {
+      size_t prev {rows.size() - width};
+      rows.resize(rows.size() + width);
+      size_t* row {rows.data() + prev + width};
+      const size_t* prev_row {rows.data() + prev};
+      row[0] = prev_row[0] + 1;
+      size_t best {row[0]};
+      for (size_t pos = 1; pos < width; ++pos) {
+        row[pos] = std::min({prev_row[pos] + 1, row[pos - 1] + 1, prev_row[pos - 1] + (Traits::key(word[pos - 1]) != Traits::key(letter))});
+        best = std::min(best, row[pos]);
+      }
+      path.push_back(letter);
+      return best;
+    };
+    auto pop_letters = [&](size_t count) {
+      rows.resize(rows.size() - count * width);
+      path.resize(path.size() - count);
+    };
+    auto visit = [&](auto& self, node_id node_idx) -> void {
+      auto letters {store.letters(node_idx)};
+      size_t pushed {0};
+      for (const auto& letter : letters) {
+        ++pushed;
+        if (push_letter(letter) > max_distance) {
+          pop_letters(pushed);
+          return;
+        }
+      }
+      if (store.word(node_idx) && rows.back() <= max_distance) {
+        found.push_back({path, rows.back()});
+      }
+      store.forBranches(node_idx, [&self](node_id branch){self(self, branch);});
+      if (delim && store.postfix(node_idx) != no_node) {
+        if (push_letter(*delim) <= max_distance) {
+          self(self, store.postfix(node_idx));
+        }
+        pop_letters(1);
+      }
+      pop_letters(pushed);
+    };
+    visit(visit, root);
 
-            //  Modifing existing node
-            std::swap(equal_str, *tree_node->letters);
-            auto old_key = old_word_ins.front();
-            unique_ptr<Leaf<T>> old_node;
-            if (tree_node->main_branches) {
-              old_node = make_unique<Leaf<T>>(std::move(old_word_ins), std::move(tree_node->main_branches), std::move(tree_node->postfix_tree));
-            } else {
-              old_node = make_unique<Leaf<T>>(std::move(old_word_ins), std::move(tree_node->postfix_tree));
-            }
-            tree_node->main_branches = make_unique<unordered_map<T, unique_ptr<Leaf<T>>>>();
-            tree_node->main_branches->emplace(std::make_pair(old_key, std::move(old_node)));
-            if (!new_word_ins.empty()) {
-              auto new_key = new_word_ins.front();
-              auto new_node = make_unique<Leaf<T>>(std::move(new_word_ins), std::move(post_str));
-              tree_node->main_branches->emplace(std::make_pair(new_key, std::move(new_node)));
-            }
-          }
+    std::stable_sort(found.begin(), found.end(), [](const auto& left, const auto& right){return left.distance < right.distance;});
+    return found;
+  }
 
-          //  Just add a new postfix part or creating a new node by a rest of a new word
-          if (equal_str_cmp == 0) {
+  ///  Compiled tree image flags
+  inline constexpr std::uint32_t image_dict {1}; //  Image of a Dict, delimiter is valid
+  inline constexpr std::uint32_t image_levels {2}; //  Image of a HierDict, delimiter is valid
+  ///  Header of a compiled tree image. Every image part is addressed by an offset from the image start,
+  ///  numbers are in native byte order of a writer
+  struct ImageHeader {
+    char magic[8] {'C', 'L', 'I', 'D', 'I', 'C', 'T', '\0'};
+    std::uint32_t byte_order {0x01020304};
+    std::uint32_t version {2}; //  2 - branch keys in keyLess order, char keys as unsigned
+    std::uint32_t letter_size {0}; //  Size of a letter type
+    std::uint32_t flags {0};
+    std::uint64_t delim {0}; //  Dict delimiter
+    std::uint32_t root {0};
+    std::uint32_t nodes_count {0};
+    std::uint32_t branches_count {0};
+    std::uint32_t letters_count {0};
+    std::uint64_t nodes_offset {0};
+    std::uint64_t branch_nodes_offset {0};
+    std::uint64_t branch_keys_offset {0};
+    std::uint64_t letters_offset {0};
+    std::uint64_t size {0}; //  Whole image size
+  };
+  ///  Compiled tree node - label and sorted branches are ranges of image arrays
+  struct ImageNode {
+    std::uint32_t letters_pos;
+    std::uint32_t letters_len;
+    std::uint32_t branches_pos;
+    std::uint32_t branches_count;
+    node_id postfix_tree;
+    std::uint32_t word;
+  };
 
-            //  A new node case
-            if (pre_str.size() > equal_str.size()) {
-              if (!tree_node->main_branches) {
-                tree_node->main_branches = make_unique<unordered_map<T, unique_ptr<Leaf<T>>>>();
-              }
-              vector<T> new_word_ins;
-              std::copy(pre_str.begin() + equal_str.size(), pre_str.end(), std::back_inserter<vector<T>>(new_word_ins));
-              auto new_key = new_word_ins.front();
-              auto new_node = make_unique<Leaf<T>>(std::move(new_word_ins), std::move(post_str));
-              tree_node->main_branches->emplace(std::make_pair(new_key, std::move(new_node)));
-            }
+  ///  Check a compiled image of any letters - a header, a layout and every node: labels, branches and postfix trees
+  ///  should be inside of image arrays. One pass over nodes and branches, an image read from a file should be checked
+  ///  before a use
+  inline bool validImage(span<const std::byte> image) noexcept {
+    const ImageHeader reference {};
+    if (image.size() < sizeof(ImageHeader) || reinterpret_cast<std::uintptr_t>(image.data()) % alignof(ImageHeader)) {
+      return false;
+    }
+    auto head {reinterpret_cast<const ImageHeader*>(image.data())};
+    if (!std::equal(std::begin(head->magic), std::end(head->magic), std::begin(reference.magic)) || head->byte_order != reference.byte_order ||
+        head->version != reference.version || head->letter_size == 0 || head->letter_size > sizeof(std::uint64_t) ||
+        head->size > image.size() || head->root >= head->nodes_count) {
+      return false;
+    }
+    //  An array of bytes at offset ends before end, no offset sum could overflow
+    auto fits = [](std::uint64_t offset, std::uint64_t bytes, std::uint64_t end) {return offset <= end && bytes <= end - offset;};
+    if (head->nodes_offset % alignof(ImageNode) || head->branch_nodes_offset % alignof(node_id) ||
+        !fits(head->nodes_offset, std::uint64_t{head->nodes_count} * sizeof(ImageNode), head->branch_nodes_offset) ||
+        !fits(head->branch_nodes_offset, std::uint64_t{head->branches_count} * sizeof(node_id), head->branch_keys_offset) ||
+        !fits(head->branch_keys_offset, std::uint64_t{head->branches_count} * head->letter_size, head->letters_offset) ||
+        !fits(head->letters_offset, std::uint64_t{head->letters_count} * head->letter_size, head->size)) {
+      return false;
+    }
+    auto nodes {reinterpret_cast<const ImageNode*>(image.data() + head->nodes_offset)};
+    auto branch_nodes {reinterpret_cast<const node_id*>(image.data() + head->branch_nodes_offset)};
+    for (std::uint32_t node_idx = 0; node_idx < head->nodes_count; ++node_idx) {
+      const ImageNode& node {nodes[node_idx]};
+      if (std::uint64_t{node.letters_pos} + node.letters_len > head->letters_count ||
+          std::uint64_t{node.branches_pos} + node.branches_count > head->branches_count ||
+          (node.postfix_tree != no_node && node.postfix_tree >= head->nodes_count)) {
+        return false;
+      }
+    }
+    //  A branch label starts with its key, so it is never empty
+    return std::all_of(branch_nodes, branch_nodes + head->branches_count, [&](node_id branch){
+      return branch < head->nodes_count && nodes[branch].letters_len != 0;
+    });
+  }
 
-            //  Just add a post part
-            if (pre_str.size() == equal_str.size()) {
-              if (!tree_node->postfix_tree) {
-                tree_node->postfix_tree = make_unique<Node<T>>(std::move(post_str));
-              } else {
-                tree_node->postfix_tree->ins(std::move(post_str));
-              }
+  ///  Read only view of a compiled tree image - nodes are read straight from the image bytes, nothing is copied
+  template <typename T> class ImageView {
+    private :
+      const ImageHeader* header {nullptr};
+      const ImageNode* nodes {nullptr};
+      const node_id* branch_nodes {nullptr};
+      const T* branch_keys {nullptr};
+      const T* letters_pool {nullptr};
+    public :
+      ImageView () = default;
+      ///  Bind to a trusted image (made by freeze in this process), on any header or layout mismatch the view stays
+      ///  empty. Nodes are not checked, see validate
+      explicit ImageView (span<const std::byte> image) noexcept {
+        const ImageHeader reference {};
+        if (image.size() < sizeof(ImageHeader) || reinterpret_cast<std::uintptr_t>(image.data()) % alignof(ImageHeader)) {
+          return;
+        }
+        auto head {reinterpret_cast<const ImageHeader*>(image.data())};
+        if (!std::equal(std::begin(head->magic), std::end(head->magic), std::begin(reference.magic)) || head->byte_order != reference.byte_order ||
+            head->version != reference.version || head->letter_size != sizeof(T) || head->size > image.size() || head->root >= head->nodes_count) {
+          return;
+        }
+        if (head->nodes_offset % alignof(ImageNode) || head->branch_keys_offset % alignof(T) || head->letters_offset % alignof(T) ||
+            head->nodes_offset + head->nodes_count * sizeof(ImageNode) > head->branch_nodes_offset ||
+            head->branch_nodes_offset + head->branches_count * sizeof(node_id) > head->branch_keys_offset ||
+            head->branch_keys_offset + head->branches_count * sizeof(T) > head->letters_offset ||
+            head->letters_offset + head->letters_count * sizeof(T) > head->size) {
+          return;
+        }
+        header = head;
+        nodes = reinterpret_cast<const ImageNode*>(image.data() + head->nodes_offset);
+        branch_nodes = reinterpret_cast<const node_id*>(image.data() + head->branch_nodes_offset);
+        branch_keys = reinterpret_cast<const T*>(image.data() + head->branch_keys_offset);
+        letters_pool = reinterpret_cast<const T*>(image.data() + head->letters_offset);
+      }
+      ///  Check every node of a bound image (validImage), the view is left empty if the image is damaged.
+      ///  Returns the view is bound
+      bool validate() noexcept {
+        if (header && !validImage({reinterpret_cast<const std::byte*>(header), static_cast<size_t>(header->size)})) {
+          *this = ImageView{};
+        }
+        return header;
+      }
+      ///  Image header, null for an empty view
+      const ImageHeader* head() const noexcept {return header;}
+      ///  Label of a node
+      span<const T> letters(node_id id) const noexcept {return {letters_pool + nodes[id].letters_pos, nodes[id].letters_len};}
+      ///  Branch of a node by first letter
+      node_id branch(node_id id, const T& key) const noexcept {
+        const ImageNode& node {nodes[id]};
+        const T* keys {branch_keys + node.branches_pos};
+        const T* keys_end {keys + node.branches_count};
+        const T* key_it {node.branches_count <= 8 ? std::find(keys, keys_end, key) : std::lower_bound(keys, keys_end, key, keyLess<T>)};
+        return key_it != keys_end && *key_it == key ? branch_nodes[node.branches_pos + (key_it - keys)] : no_node;
+      }
+      ///  Root of a node postfix tree
+      node_id postfix(node_id id) const noexcept {return nodes[id].postfix_tree;}
+      ///  Node is an end of an inserted word
+      bool word(node_id id) const noexcept {return nodes[id].word;}
+      ///  Call fn for every branch of a node in order of keys
+      template <typename F> void forBranches(node_id id, F&& fn) const {
+        const ImageNode& node {nodes[id]};
+        std::for_each(branch_nodes + node.branches_pos, branch_nodes + node.branches_pos + node.branches_count, std::forward<F>(fn));
+      }
+  };
+
+  ///  Write a compiled image to a file
+  inline bool saveImage(const std::filesystem::path& path, span<const std::byte> image) {
+    std::ofstream file {path, std::ios::binary | std::ios::trunc};
+    file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+    return static_cast<bool>(file.flush());
+  }
+
+  ///  Lazy range of all words starting with a prefix, in order of keys. Words are made one by one in a single reused
+  ///  buffer when the range is iterated, so taking first N words costs just these N words. The tree should outlive
+  ///  the range. Store is a nodes storage with letters(node), word(node), postfix(node) and forBranches(node, fn)
+  template <typename T, typename Store> class Completions {
+    private :
+      struct Step {
+        node_id node;
+        size_t len; //  Buffer size before the node label
+        bool postfix; //  Node is a postfix tree root, delimiter goes first
+      };
+      const Store* store {nullptr};
+      T delim {};
+      size_t limit {0};
+      vector<Step> stack;
+      vector<node_id> branches;
+      vector<T> buffer;
+      bool started {false};
+      bool has_word {false};
+
+      //  Going down to a next word
+      bool next() {
+        while (limit && !stack.empty()) {
+          Step step {stack.back()};
+          stack.pop_back();
+          buffer.resize(step.len);
+          if (step.postfix) {
+            buffer.push_back(delim);
+          }
+          auto letters {store->letters(step.node)};
+          buffer.insert(buffer.end(), letters.begin(), letters.end());
+
+          //  Branches go to the stack in reverse order, postfix tree takes a place of the delimiter letter
+          branches.clear();
+          store->forBranches(step.node, [this](node_id branch){branches.push_back(branch);});
+          node_id postfix_root {store->postfix(step.node)};
+          auto postfix_pos {ranges::partition_point(branches, [this](node_id branch){
+            return keyLess<T>(store_traits<Store, T>::key(store->letters(branch).front()), store_traits<Store, T>::key(delim));
+          })};
+          for (auto branch_it = branches.end(); branch_it != branches.begin(); --branch_it) {
+            if (branch_it == postfix_pos && postfix_root != no_node) {
+              stack.push_back({postfix_root, buffer.size(), true});
             }
+            stack.push_back({*(branch_it - 1), buffer.size(), false});
           }
-        } else {  // Creating new node for empty root node (root leaf)
-          T new_key = letters.front();
-          unique_ptr<Leaf<T>> new_node;
-          if (!post_str.empty()) {
-            new_node = make_unique<Leaf<T>> (std::move(pre_str), std::move(post_str));
-          } else {
-            new_node = make_unique<Leaf<T>> (std::move(pre_str));
+          if (postfix_pos == branches.begin() && postfix_root != no_node) {
+            stack.push_back({postfix_root, buffer.size(), true});
+          }
+
+          if (store->word(step.node)) {
+            --limit;
+            return true;
           }
-          root->emplace(std::make_pair(new_key, std::move(new_node)));
-          return true;
         }
-        return ret;
+        stack.clear();
+        return false;
       }
-      ///  Get an item from container
-      [[nodiscard]] unique_ptr<vector<T>> get(vector<T> const &&word) const noexcept {
-        unique_ptr<vector<T>> ret;
-        bool postfix {false};
-        vector<T> pre_str, post_str;
+    public :
+      class iterator {
+        private :
+          Completions* range {nullptr};
+        public :
+          using iterator_concept = std::input_iterator_tag;
+          using value_type = span<const T>;
+          using difference_type = std::ptrdiff_t;
+          iterator () = default;
+          explicit iterator (Completions* range) : range{range} {}
+          ///  Current word, valid till the iterator is moved
+          value_type operator*() const noexcept {return range->buffer;}
+          iterator& operator++() {
+            range->has_word = range->next();
+            if (!range->has_word) {
+              range = nullptr;
+            }
+            return *this;
+          }
+          void operator++(int) {++*this;}
+          friend bool operator== (const iterator& it, std::default_sentinel_t) noexcept {return !it.range;}
+      };
 
-        //  Check data
-        if (word.empty()) {
-          return ret;
+      Completions () = default;
+      ///  Words of a node subtree, head is a word part before the node label
+      Completions (const Store& store, node_id node, span<const T> head, size_t limit, T delim = T{}) :
+        store{&store}, delim{delim}, limit{limit}, stack{{node, head.size(), false}}, buffer(head.begin(), head.end()) {}
+      iterator begin() {
+        if (!started) {
+          started = true;
+          has_word = next();
         }
+        return has_word ? iterator{this} : iterator{};
+      }
+      std::default_sentinel_t end() const noexcept {return {};}
+  };
 
-        //  Divide string into pre and post parts
-        if (auto delim_it = ranges::find(word, delim); delim_it != word.end()) {
-          postfix = true;
-          ranges::move(std::make_move_iterator(delim_it + 1), std::make_move_iterator(word.end()), std::back_inserter(post_str));
-          ranges::move(std::make_move_iterator(word.begin()), std::make_move_iterator(delim_it), std::back_inserter(pre_str));
-        } else {
-          ranges::move(std::make_move_iterator(word.begin()), std::make_move_iterator(word.end()), std::back_inserter(pre_str));
-        }
-
-        if (root->contains(pre_str.front())) {
-          auto node = Node<T>::goTree(root->at(pre_str.front()).get(), vector<T>{pre_str});
-          if (node.second) {
-            ret = make_unique<vector<T>>(pre_str.begin(), pre_str.begin() + node.first.first);
-            ret->insert(ret->end(), node.second->letters->begin(), node.second->letters->end());
-            if (postfix) {
-              ret->push_back(delim);
-              if (!post_str.empty()) {
-                auto post_part = node.second->postfix_tree->get(vector<T>{post_str});
-                if (post_part) {
-                  std::move(post_part->begin(), post_part->end(), std::back_inserter(*ret));
+  ///  Number of items in a node subtree - ended words, postfix (level) trees included
+  template <typename Store> size_t countItems(const Store& store, node_id node_idx) {
+    size_t count {0};
+    vector<node_id> stack {node_idx};
+    while (!stack.empty()) {
+      node_id node {stack.back()};
+      stack.pop_back();
+      count += store.word(node);
+      store.forBranches(node, [&stack](node_id branch){stack.push_back(branch);});
+      if (store.postfix(node) != no_node) {
+        stack.push_back(store.postfix(node));
+      }
+    }
+    return count;
+  }
+
+  ///  Incremental lookup of a word typed letter by letter. A cursor keeps a reached node and a number of matched
+  ///  letters of its label, so push and pop are O(1) - one label letter compare or one branch lookup. A delimiter
+  ///  moves a cursor to a postfix (level) tree of a reached node, up to levels times. Results are the same as
+  ///  get/contains of a container give for a whole typed word. The tree should outlive the cursor, any change of
+  ///  the tree makes the cursor invalid
+  template <typename T, typename Store> class Cursor {
+    private :
+      //  Cursor state after a typed letter
+      struct Step {
+        node_id level_root; //  Root of a current level tree, no_node - a level without a tree
+        node_id node; //  Reached node, level_root for a start of a level
+        std::uint32_t matched {0}; //  Letters of the node label equal to typed ones
+        std::uint32_t level {0}; //  Delimiters passed
+        size_t text_len {0}; //  Completed levels and typed letters of a current one
+        bool level_word {false}; //  Level is started by a delimiter after an item (Dict "item-")
+      };
+      const Store* store {nullptr};
+      std::optional<T> delim;
+      std::uint32_t levels {0};
+      vector<Step> steps;
+      vector<T> text; //  Previous levels are completed till their node ends
+      size_t dead {0}; //  Letters typed after a lookup failed
+
+      const Step& top() const noexcept {return steps.back();}
+      bool levelStart() const noexcept {return top().node == top().level_root;}
+      //  Next level on a delimiter, word completion of a current level is kept in text
+      bool pushDelim(const T& letter) {
+        Step step {top()};
+        if (levelStart()) {
+          return false;
+        }
+        auto rest {store->letters(step.node).subspan(step.matched)};
+        text.insert(text.end(), rest.begin(), rest.end());
+        text.push_back(letter);
+        step.level_word = step.matched == store->letters(step.node).size() && store->word(step.node) && levels == 1;
+        step.level_root = step.node = store->postfix(step.node);
+        step.matched = 0;
+        ++step.level;
+        step.text_len = text.size();
+        steps.push_back(step);
+        return true;
+      }
+      bool pushLetter(const T& letter) {
+        Step step {top()};
+        if (step.node == no_node) {
+          return false;
+        }
+        auto letters {store->letters(step.node)};
+        if (step.matched < letters.size()) {
+          if (store_traits<Store, T>::key(letters[step.matched]) != store_traits<Store, T>::key(letter)) {
+            return false;
+          }
+        } else {
+          node_id branch {store->branch(step.node, letter)};
+          if (branch == no_node) {
+            return false;
+          }
+          step.node = branch;
+          step.matched = 0;
+        }
+        ++step.matched;
+        text.push_back(letter);
+        step.text_len = text.size();
+        steps.push_back(step);
+        return true;
+      }
+    public :
+      Cursor () = default;
+      ///  Cursor at a root of a tree, a delimiter starts a next level tree up to levels times
+      Cursor (const Store& store, node_id root, std::optional<T> delim = std::nullopt, std::uint32_t levels = 0) :
+        store{&store}, delim{delim}, levels{delim ? levels : 0}, steps{{root, root}} {}
+
+      ///  Type a letter, false if no item starts with typed letters any more
+      bool push(const T& letter) {
+        if (!dead) {
+          bool level_delim {delim && letter == *delim && top().level < levels};
+          if (level_delim ? pushDelim(letter) : pushLetter(letter)) {
+            return true;
+          }
+        }
+        ++dead;
+        return false;
+      }
+      ///  Remove the last typed letter
+      void pop() noexcept {
+        if (dead) {
+          --dead;
+        } else if (steps.size() > 1) {
+          steps.pop_back();
+          text.resize(top().text_len);
+        }
+      }
+      ///  Remove all typed letters
+      void clear() noexcept {
+        steps.resize(1);
+        text.clear();
+        dead = 0;
+      }
+      ///  Number of typed letters
+      [[nodiscard]] size_t size() const noexcept {return steps.size() - 1 + dead;}
+      ///  Some item starts with typed letters
+      [[nodiscard]] bool valid() const noexcept {return !dead;}
+      ///  Reached node and matched letters of its label
+      [[nodiscard]] node_id node() const noexcept {return dead ? no_node : top().node;}
+      [[nodiscard]] size_t offset() const noexcept {return dead ? 0 : top().matched;}
+      ///  Letters all items starting with typed ones share next - the rest of a reached node label
+      [[nodiscard]] span<const T> extension() const noexcept {
+        if (dead || levelStart()) {
+          return {};
+        }
+        return store->letters(top().node).subspan(top().matched);
+      }
+      ///  Typed word completion, the same as a container get gives
+      [[nodiscard]] unique_ptr<vector<T>> completion() const {
+        unique_ptr<vector<T>> ret;
+        if (!dead && !(levelStart() && top().level == 0)) {
+          auto rest {extension()};
+          ret = make_unique<vector<T>>(text);
+          ret->insert(ret->end(), rest.begin(), rest.end());
+        }
+        return ret;
+      }
+      ///  Typed letters are a whole item
+      [[nodiscard]] bool complete() const noexcept {
+        if (dead) {
+          return false;
+        }
+        if (levelStart()) {
+          return top().level_word;
+        }
+        return top().matched == store->letters(top().node).size() && store->word(top().node);
+      }
+      ///  Number of items starting with typed letters, O(1) for a store keeping subtree counts, otherwise
+      ///  O(size of a reached subtree)
+      [[nodiscard]] size_t candidates() const {
+        if (dead || top().node == no_node) {
+          return dead ? 0 : top().level_word;
+        }
+        size_t items;
+        if constexpr (requires {store->items(top().node);}) {
+          items = store->items(top().node);
+        } else {
+          items = countItems(*store, top().node);
+        }
+        return items + (levelStart() && top().level_word);
+      }
+  };
+
+  ///  Radix tree to store commands - a dictionary, as a matter of fact
+  template <typename T, typename Alloc, LetterTraitsOf<T> Traits> class RadixTree {
+    protected :
+      static constexpr size_t bulk_min_words {1 << 14}; //  Smaller bulk inserts are not worth threads
+      NodeArena<T, Alloc, Traits> arena;
+      node_id root_branches; //  Root node - has no label, just branches
+      bool shared_nodes {false}; //  Equal subtrees are kept once by minimize
+      CLIDICT_STAT(mutable OpCounters op_counters;) //  Not synchronized, as any change of a tree
+
+      //  Divide node label into two parts, the rest of a label goes to a new branch with all the node branches
+      void splitNode(node_id node_idx, size_t pos) {
+        node_id rest {arena.make({})};
+        TreeNode<T>& node {arena[node_idx]};
+        TreeNode<T>& rest_node {arena[rest]};
+        rest_node.letters_pos = node.letters_pos + static_cast<std::uint32_t>(pos);
+        rest_node.letters_len = node.letters_len - static_cast<std::uint32_t>(pos);
+        rest_node.key = arena.letters(rest_node).front();
+        rest_node.main_branches = node.main_branches;
+        rest_node.branches_count = node.branches_count;
+        rest_node.branches_kind = node.branches_kind;
+        rest_node.postfix_tree = node.postfix_tree;
+        rest_node.word = node.word;
+        rest_node.items = node.items;
+        rest_node.value = node.value;
+        node.letters_len = static_cast<std::uint32_t>(pos);
+        node.branches_count = 0;
+        node.branches_kind = BranchKind::none;
+        node.postfix_tree = no_node;
+        node.word = false;
+        node.value = no_node;
+        arena.addBranch(node_idx, rest);
+      }
+      //  Count a lookup result, a no-op unless built with CLIDICT_STATS
+      bool countLookup([[maybe_unused]] bool found) const noexcept {
+        CLIDICT_STAT(++op_counters.lookups; op_counters.failed_lookups += !found;)
+        return found;
+      }
+      //  Count an insert result, a no-op unless built with CLIDICT_STATS
+      bool countInsert(bool inserted) noexcept {
+        CLIDICT_STAT(op_counters.inserts += inserted;)
+        return inserted;
+      }
+      //  Find a node of a tree with word
+      TreePos goTree(node_id root, span<const T> word) const noexcept {return walkTree(arena, root, word);}
+      //  Add a word to a tree, returns a node where the word ends
+      node_id insTree(node_id root, span<const T> word) {
+        auto pos {goTree(root, word)};
+
+        //  Word ends or differs in the middle of a node - dividing existing node
+        if (pos.matched != arena[pos.node].letters_len) {
+          splitNode(pos.node, pos.matched);
+          CLIDICT_STAT(++op_counters.splits;)
+        }
+        size_t word_pos {pos.depth + pos.matched};
+        if (word_pos == word.size()) {
+          return pos.node;
+        }
+
+        //  Just add a rest of a word to a new branch
+        node_id branch {arena.make(word.subspan(word_pos))};
+        arena.addBranch(pos.node, branch);
+        return branch;
+      }
+      //  Count new words (a word or a subtree) in nodes from a root to the word end, the word is in the tree.
+      //  Returns the end node
+      node_id countPath(node_id root, span<const T> word, std::uint32_t added = 1) noexcept {
+        node_id node_idx {root};
+        arena[node_idx].items += added;
+        for (size_t word_pos = 0; word_pos < word.size(); word_pos += arena[node_idx].letters_len) {
+          node_idx = arena.branch(node_idx, word[word_pos]);
+          arena[node_idx].items += added;
+        }
+        return node_idx;
+      }
+      //  Count words of all subtrees from scratch, children are counted before parents
+      void recountItems() {
+        vector<node_id> order {root_branches};
+        for (size_t pos = 0; pos < order.size(); ++pos) {
+          const TreeNode<T>& node {arena[order[pos]]};
+          arena.forBranches(node, [&order](node_id branch){order.push_back(branch);});
+          if (node.postfix_tree != no_node) {
+            order.push_back(node.postfix_tree);
+          }
+        }
+        for (auto node_it = order.rbegin(); node_it != order.rend(); ++node_it) {
+          TreeNode<T>& node {arena[*node_it]};
+          std::uint32_t items {node.word};
+          arena.forBranches(node, [this, &items](node_id branch){items += arena[branch].items;});
+          if (node.postfix_tree != no_node) {
+            items += arena[node.postfix_tree].items;
+          }
+          node.items = items;
+        }
+      }
+      //  Words of a subtree one by one in order of keys (postfix tree at a place of the delimiter), the k-th one
+      //  is added to the end of ret. Returns false if the subtree has less words
+      bool kthItem(node_id node_idx, size_t k, vector<T>& ret, std::optional<T> delim = std::nullopt) const {
+        if (k >= arena[node_idx].items) {
+          return false;
+        }
+        for (;;) {
+          const TreeNode<T>& node {arena[node_idx]};
+          auto letters {arena.letters(node)};
+          ret.insert(ret.end(), letters.begin(), letters.end());
+          if (node.word) {
+            if (k == 0) {
+              return true;
+            }
+            --k;
+          }
+          node_id next {no_node};
+          bool postfix_done {node.postfix_tree == no_node};
+          auto visit_postfix = [&]() {
+            postfix_done = true;
+            if (next == no_node && k < arena[node.postfix_tree].items) {
+              next = node.postfix_tree;
+              ret.push_back(*delim);
+            } else if (next == no_node) {
+              k -= arena[node.postfix_tree].items;
+            }
+          };
+          arena.forBranches(node, [&](node_id branch) {
+            if (!postfix_done && !keyLess<T>(Traits::key(arena[branch].key), Traits::key(*delim))) {
+              visit_postfix();
+            }
+            if (next == no_node) {
+              if (k < arena[branch].items) {
+                next = branch;
+              } else {
+                k -= arena[branch].items;
+              }
+            }
+          });
+          if (!postfix_done) {
+            visit_postfix();
+          }
+          node_idx = next;
+        }
+      }
+      //  Number of words of a tree ordered before a word (kthItem order), the word could be absent. A delimiter
+      //  moves the count to a postfix tree of a node, up to levels times
+      size_t rankItem(node_id root, span<const T> word, std::optional<T> delim = std::nullopt, std::uint32_t levels = 0) const noexcept {
+        size_t rank {0};
+        node_id node_idx {root};
+        node_id level_root {root};
+        for (size_t word_pos = 0; word_pos < word.size();) {
+          const TreeNode<T>& node {arena[node_idx]};
+          rank += node.word;
+          const T& letter {word[word_pos]};
+          if (delim && levels && letter == *delim) {
+            //  Node word and branches before the delimiter go first, then the postfix tree
+            arena.forBranches(node, [&](node_id branch){rank += keyLess<T>(Traits::key(arena[branch].key), Traits::key(letter)) ? arena[branch].items : 0;});
+            if (node.postfix_tree == no_node || node_idx == level_root) {
+              return rank;
+            }
+            level_root = node_idx = node.postfix_tree;
+            --levels;
+            ++word_pos;
+            continue;
+          }
+          node_id next {no_node};
+          arena.forBranches(node, [&](node_id branch) {
+            if (keyLess<T>(Traits::key(arena[branch].key), Traits::key(letter))) {
+              rank += arena[branch].items;
+            } else if (Traits::key(arena[branch].key) == Traits::key(letter)) {
+              next = branch;
+            }
+          });
+          if (delim && levels && node.postfix_tree != no_node && keyLess<T>(Traits::key(*delim), Traits::key(letter))) {
+            rank += arena[node.postfix_tree].items;
+          }
+          if (next == no_node) {
+            return rank;
+          }
+          auto letters {arena.letters(next)};
+          size_t common {commonPrefix<T, Traits>(letters, word.subspan(word_pos))};
+          if (common != letters.size()) {
+            //  Word differs inside of a label or ends there - the whole branch is after or before it
+            if (word_pos + common != word.size() && keyLess<T>(Traits::key(letters[common]), Traits::key(word[word_pos + common]))) {
+              rank += arena[next].items;
+            }
+            return rank;
+          }
+          node_idx = next;
+          word_pos += letters.size();
+        }
+        return rank;
+      }
+      //  A change of a minimized tree goes to own copies of shared nodes, nodes are copied once by compact
+      void unshare() {
+        if (shared_nodes) {
+          compact();
+        }
+      }
+      //  Add a word, returns a node where the new word ends or no_node for an empty word or a word in the tree already
+      node_id insWord(span<const T> letters) {
+        if (letters.empty()) {
+          return no_node;
+        }
+        unshare();
+        node_id node_idx {insTree(root_branches, letters)};
+        if (arena[node_idx].word) {
+          return no_node;
+        }
+        arena[node_idx].word = true;
+        countPath(root_branches, letters);
+        return node_idx;
+      }
+      //  Bulk insert goes word by word into a non empty tree, for a few words or threads and with a stateful
+      //  allocator - memory resources are not expected to be shared by threads
+      bool bulkSerial(size_t count, size_t thread_count) const noexcept {
+        return arena[root_branches].branches_count != 0 || thread_count < 2 || count < bulk_min_words ||
+               !std::allocator_traits<Alloc>::is_always_equal::value;
+      }
+      //  Build an empty tree of many words by threads. Words are divided into parts by leading letters - by a first
+      //  one and by longer prefixes for parts too big (skewed data), down to key_len(word) letters (a word or
+      //  a pre part size). Threads take parts biggest first, every part is a tree of words without the part prefix
+      //  made by make_sub and filled by ins_sub. Part trees are joined to a main tree in one thread, words equal
+      //  to a part prefix are inserted by ins_main at the end. Returns a number of inserted words
+      template <typename Sub, typename MakeSub, typename InsSub, typename InsMain, typename KeyLen>
+      size_t bulkInsert(vector<span<const T>>&& words, size_t thread_count, MakeSub make_sub, InsSub ins_sub, InsMain ins_main, KeyLen key_len) {
+        struct Part {
+          size_t depth; //  Prefix size
+          vector<span<const T>> words;
+        };
+        const size_t target {std::max<size_t>(words.size() / (thread_count * 8), 1024)};
+        constexpr size_t max_depth {64};
+        vector<Part> parts;
+        vector<Part> pending;
+        vector<span<const T>> short_words; //  Words equal to a part prefix
+        pending.push_back({0, std::move(words)});
+        while (!pending.empty()) {
+          Part part {std::move(pending.back())};
+          pending.pop_back();
+          const bool last {part.depth > 0 && (part.words.size() <= target || part.depth == max_depth)};
+          std::map<T, vector<span<const T>>> groups;
+          for (const auto& word : part.words) {
+            if (key_len(word) <= part.depth) {
+              short_words.push_back(word);
+            } else if (!last) {
+              groups[Traits::key(word[part.depth])].push_back(word);
+            }
+          }
+          if (last) {
+            std::erase_if(part.words, [&key_len, depth = part.depth](const auto& word){return key_len(word) <= depth;});
+            if (!part.words.empty()) {
+              parts.push_back(std::move(part));
+            }
+            continue;
+          }
+          for (auto& [key, group] : groups) {
+            pending.push_back({part.depth + 1, std::move(group)});
+          }
+        }
+        ranges::sort(parts, std::greater{}, [](const Part& part){return part.words.size();});
+
+        //  Part trees, threads take a next part by a shared counter - it stands for a work-stealing pool, a thread
+        //  done with a part steals the next one. A first exception stops the counter and is rethrown when all
+        //  threads are joined, the tree is not changed yet
+        vector<std::optional<Sub>> subs(parts.size());
+        std::atomic<size_t> next_part {0};
+        std::atomic<size_t> inserted {0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto build = [&]() {
+          try {
+            for (size_t part_idx {next_part++}; part_idx < parts.size(); part_idx = next_part++) {
+              Sub& sub {subs[part_idx].emplace(make_sub())};
+              size_t count {0};
+              for (const auto& word : parts[part_idx].words) {
+                count += ins_sub(sub, word.subspan(parts[part_idx].depth)) != no_node;
+              }
+              inserted += count;
+            }
+          } catch (...) {
+            std::lock_guard lock {error_mutex};
+            if (!error) {
+              error = std::current_exception();
+            }
+            next_part = parts.size();
+          }
+        };
+        {
+          vector<std::jthread> threads; //  Joined on scope exit, a failed thread start included
+          for (size_t thread = 1; thread < std::min(thread_count, parts.size()); ++thread) {
+            threads.emplace_back(build);
+          }
+          build();
+        }
+        if (error) {
+          std::rethrow_exception(error);
+        }
+
+        //  Part tree root branches go to a node of the part prefix
+        size_t top_depth {0};
+        for (size_t part_idx = 0; part_idx < parts.size(); ++part_idx) {
+          const RadixTree& sub {*subs[part_idx]};
+          auto prefix {parts[part_idx].words.front().first(parts[part_idx].depth)};
+          top_depth = std::max(top_depth, prefix.size());
+          node_id sub_root {arena.append(sub.arena) + sub.root_branches};
+          node_id node_idx {insTree(root_branches, prefix)};
+          TreeNode<T>& node {arena[node_idx]};
+          TreeNode<T>& root_node {arena[sub_root]};
+          node.main_branches = root_node.main_branches;
+          node.branches_count = root_node.branches_count;
+          node.branches_kind = root_node.branches_kind;
+          root_node.branches_kind = BranchKind::none; //  The set belongs to the node now
+          const std::uint32_t items {root_node.items};
+          arena.release(sub_root);
+          countPath(root_branches, prefix, items);
+          subs[part_idx].reset();
+        }
+
+        //  Nodes of prefixes left with a single branch are joined with it
+        vector<pair<node_id, size_t>> stack {{root_branches, 0}};
+        while (!stack.empty()) {
+          auto [node_idx, depth] {stack.back()};
+          stack.pop_back();
+          if (node_idx != root_branches) {
+            while (depth < top_depth && arena[node_idx].branches_count == 1 && !arena[node_idx].word && arena[node_idx].postfix_tree == no_node) {
+              mergeNode(node_idx);
+            }
+            depth += arena[node_idx].letters_len;
+          }
+          if (depth < top_depth) {
+            arena.forBranches(node_idx, [&stack, depth](node_id branch){stack.push_back({branch, depth});});
+          }
+        }
+        for (const auto& word : short_words) {
+          inserted += ins_main(word) != no_node;
+        }
+        CLIDICT_STAT(op_counters.inserts += inserted;)
+        return inserted;
+      }
+      //  Find a node where the word ends exactly
+      node_id findWord(node_id root, span<const T> word) const noexcept {return radix_dict::findWord(arena, root, word);}
+      //  Add a word completion (word with a rest of a last node) to the end of ret, returns the last node
+      node_id getTree(node_id root, span<const T> word, vector<T>& ret) const {return completeWord(arena, root, word, ret);}
+      //  Nodes from a root to a node where the word ends exactly, empty if there is no such node
+      vector<node_id> pathTo(node_id root, span<const T> word) const {
+        vector<node_id> path {root};
+        for (size_t word_pos = 0; word_pos < word.size();) {
+          node_id branch {arena.branch(path.back(), word[word_pos])};
+          if (branch == no_node) {
+            return {};
+          }
+          auto letters {arena.letters(branch)};
+          if (commonPrefix<T, Traits>(letters, word.subspan(word_pos)) != letters.size()) {
+            return {};
+          }
+          path.push_back(branch);
+          word_pos += letters.size();
+        }
+        return path;
+      }
+      //  Join a node having a single branch with the branch, a tree stays path compressed
+      void mergeNode(node_id node_idx) {
+        node_id child {no_node};
+        arena.forBranches(node_idx, [&child](node_id branch){child = branch;});
+        vector<T> label {arena.letters(node_idx).begin(), arena.letters(node_idx).end()};
+        auto child_letters {arena.letters(child)};
+        label.insert(label.end(), child_letters.begin(), child_letters.end());
+        arena.relabel(node_idx, label);
+
+        TreeNode<T>& node {arena[node_idx]};
+        TreeNode<T>& child_node {arena[child]};
+        arena.freeBranches(node);
+        node.main_branches = child_node.main_branches;
+        node.branches_count = child_node.branches_count;
+        node.branches_kind = child_node.branches_kind;
+        node.postfix_tree = child_node.postfix_tree;
+        node.word = child_node.word;
+        node.items = child_node.items;
+        node.value = child_node.value;
+        child_node.branches_kind = BranchKind::none; //  The set belongs to the node now
+        child_node.branches_count = 0;
+        arena.release(child);
+      }
+      //  Move words of a node to a node of the same path (the node label is dropped) - a word mark, a postfix tree
+      //  and branches go to the other node, shared parts are joined. Returns a number of new words
+      std::uint32_t joinTrees(node_id node_idx, node_id other_idx) {
+        std::uint32_t added {0};
+        TreeNode<T>& node {arena[node_idx]};
+        TreeNode<T>& other {arena[other_idx]};
+        if (other.word && !node.word) {
+          node.word = true;
+          ++added;
+        }
+        if (other.postfix_tree != no_node) {
+          if (node.postfix_tree == no_node) {
+            node.postfix_tree = other.postfix_tree;
+            added += arena[other.postfix_tree].items;
+          } else {
+            added += joinTrees(node.postfix_tree, other.postfix_tree);
+          }
+        }
+        vector<node_id> branches;
+        branches.reserve(other.branches_count);
+        arena.forBranches(other_idx, [&branches](node_id branch){branches.push_back(branch);});
+        for (node_id branch : branches) {
+          added += joinBranch(node_idx, branch);
+        }
+        arena.release(other_idx);
+        node.items += added;
+        return added;
+      }
+      //  Hang a subtree (a node with its label) under a node. A branch of the same key is split where labels differ,
+      //  the subtree goes to the split point. Returns a number of new words
+      std::uint32_t joinBranch(node_id node_idx, node_id subtree) {
+        node_id branch {arena.branch(node_idx, arena[subtree].key)};
+        if (branch == no_node) {
+          arena.addBranch(node_idx, subtree);
+          return arena[subtree].items;
+        }
+        const size_t common {commonPrefix<T, Traits>(arena.letters(branch), arena.letters(subtree))};
+        if (common != arena[branch].letters_len) {
+          splitNode(branch, common);
+          CLIDICT_STAT(++op_counters.splits;)
+        }
+        if (common == arena[subtree].letters_len) {
+          return joinTrees(branch, subtree);
+        }
+        TreeNode<T>& sub_node {arena[subtree]};
+        sub_node.letters_pos += static_cast<std::uint32_t>(common);
+        sub_node.letters_len -= static_cast<std::uint32_t>(common);
+        sub_node.key = arena.letters(sub_node).front();
+        const std::uint32_t added {joinBranch(branch, subtree)};
+        arena[branch].items += added;
+        return added;
+      }
+      //  Move all words of another tree of the same kind, nodes are moved to the arena at once and joined with
+      //  the tree. Returns a number of new words, the other tree is left empty
+      size_t mergeTree(RadixTree& other) {
+        if (&other == this) {
+          return 0;
+        }
+        unshare();
+        other.unshare();
+        const size_t added {joinTrees(root_branches, arena.append(other.arena) + other.root_branches)};
+        other.clear();
+        CLIDICT_STAT(op_counters.inserts += added;)
+        return added;
+      }
+      //  Remove empty nodes and merge single branch nodes going up from a path end
+      void prunePath(const vector<node_id>& path) {
+        for (size_t step = path.size() - 1; step > 0; --step) {
+          TreeNode<T>& node {arena[path[step]]};
+          if (node.word || node.postfix_tree != no_node) {
+            break;
+          }
+          if (node.branches_count == 0) {
+            const T key {node.key};
+            arena.release(path[step]);
+            arena.removeBranch(path[step - 1], key);
+            continue;
+          }
+          if (node.branches_count == 1) {
+            mergeNode(path[step]);
+          }
+          break;
+        }
+      }
+      //  Erase a word from a tree - at_end(node) changes a node where the word ends and tells if anything
+      //  was erased, then the path is pruned
+      template <typename F> bool eraseTree(node_id root, span<const T> word, F&& at_end) {
+        auto path {pathTo(root, word)};
+        if (path.size() < 2 || !at_end(path.back())) {
+          return false;
+        }
+        for (node_id node_idx : path) {
+          --arena[node_idx].items;
+        }
+        prunePath(path);
+        return true;
+      }
+      //  Clear a word flag of a node
+      bool eraseWord(node_id node_idx) noexcept {return std::exchange(arena[node_idx].word, false);}
+      //  Erase from a postfix tree of a node by erase_in(postfix root), an empty postfix tree is released
+      template <typename F> bool erasePostfix(node_id node_idx, F&& erase_in) {
+        node_id postfix_root {arena[node_idx].postfix_tree};
+        if (postfix_root == no_node || !erase_in(postfix_root)) {
+          return false;
+        }
+        if (arena[postfix_root].branches_count == 0) {
+          arena.release(postfix_root);
+          arena[node_idx].postfix_tree = no_node;
+        }
+        return true;
+      }
+
+      ///  Path of a last added word, lets add a next sorted word without walking from a tree root
+      class SortedPath {
+        private :
+          struct Step {
+            node_id node;
+            size_t end; //  Word letters up to the node label end
+          };
+          RadixTree& tree;
+          vector<Step> path;
+        public :
+          SortedPath (RadixTree& tree, node_id root) : tree{tree}, path{{root, 0}} {}
+          //  Add a word not less than a previous one. Returns a node with the word end or no_node for a word
+          //  out of order, the tree is not changed in this case
+          node_id add(span<const T> word) {
+            size_t common {0};
+            size_t step {1};
+
+            //  Common part with a previous word
+            for (; step < path.size(); ++step) {
+              auto letters {tree.arena.letters(path[step].node)};
+              auto rest {word.subspan(common)};
+              size_t matched {commonPrefix<T, Traits>(letters, rest)};
+              common += matched;
+              if (matched != letters.size()) {
+                if (matched == rest.size() || keyLess<T>(Traits::key(rest[matched]), Traits::key(letters[matched]))) {
+                  return no_node;
                 }
+                break;
+              }
+            }
+
+            //  Same word or a previous word is a prefix of the new one
+            if (step == path.size()) {
+              if (common == word.size()) {
+                return path.back().node;
+              }
+            } else if (common == path[step - 1].end) {
+              //  Differs by first letter of a node - new branch of a parent node
+              path.resize(step);
+            } else {
+              //  Differs in the middle of a node label - dividing the node
+              path.resize(step + 1);
+              tree.splitNode(path[step].node, common - path[step - 1].end);
+              path[step].end = common;
+            }
+            node_id branch {tree.arena.make(word.subspan(common))};
+            tree.arena.addBranch(path.back().node, branch);
+            path.push_back({branch, word.size()});
+            return branch;
+          }
+      };
+
+      //  Add sorted words to an empty tree in one pass, every node is made once and every letter is copied once.
+      //  Words out of order and all words after are inserted one by one
+      template <typename R> void buildSorted(R&& words) {
+        SortedPath path {*this, root_branches};
+        auto word_it {ranges::begin(words)};
+        for (; word_it != ranges::end(words); ++word_it) {
+          auto&& word {*word_it};
+          auto letters {wordSpan<T>(word)};
+          if (letters.empty()) {
+            continue;
+          }
+          node_id node_idx {path.add(letters)};
+          if (node_idx == no_node) {
+            break;
+          }
+          arena[node_idx].word = true;
+        }
+        recountItems();
+        for (; word_it != ranges::end(words); ++word_it) {
+          ins(*word_it);
+        }
+      }
+
+      //  Compile a tree to a read only image. Nodes are numbered in depth first order, labels and branches
+      //  of every node are packed into contiguous arrays
+      vector<std::byte> freezeTree(std::uint32_t flags, const T& delim) const {
+        static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(std::uint64_t), "Letters should be plain values to be compiled");
+        vector<node_id> order, image_idx(arena.size(), no_node), stack {root_branches}, branches;
+        size_t branches_total {0}, letters_total {0};
+
+        //  Numbering nodes
+        while (!stack.empty()) {
+          node_id node_idx {stack.back()};
+          stack.pop_back();
+          if (image_idx[node_idx] != no_node) {
+            continue; //  Shared node of a minimized tree
+          }
+          const TreeNode<T>& node {arena[node_idx]};
+          image_idx[node_idx] = static_cast<node_id>(order.size());
+          order.push_back(node_idx);
+          branches_total += node.branches_count;
+          letters_total += node.letters_len;
+          branches.clear();
+          arena.forBranches(node, [&branches](node_id branch){branches.push_back(branch);});
+          stack.insert(stack.end(), branches.rbegin(), branches.rend());
+          if (node.postfix_tree != no_node) {
+            stack.push_back(node.postfix_tree);
+          }
+        }
+
+        //  Image layout
+        auto align = [](size_t pos, size_t alignment) {return (pos + alignment - 1) / alignment * alignment;};
+        ImageHeader header {};
+        header.letter_size = sizeof(T);
+        header.flags = flags;
+        std::memcpy(&header.delim, &delim, sizeof(T));
+        header.root = image_idx[root_branches];
+        header.nodes_count = static_cast<std::uint32_t>(order.size());
+        header.branches_count = static_cast<std::uint32_t>(branches_total);
+        header.letters_count = static_cast<std::uint32_t>(letters_total);
+        header.nodes_offset = align(sizeof(ImageHeader), alignof(ImageNode));
+        header.branch_nodes_offset = header.nodes_offset + order.size() * sizeof(ImageNode);
+        header.branch_keys_offset = align(header.branch_nodes_offset + branches_total * sizeof(node_id), alignof(T));
+        header.letters_offset = align(header.branch_keys_offset + branches_total * sizeof(T), alignof(T));
+        header.size = align(header.letters_offset + letters_total * sizeof(T), alignof(std::uint64_t));
+
+        vector<std::byte> image(header.size);
+        std::memcpy(image.data(), &header, sizeof(header));
+        auto nodes {reinterpret_cast<ImageNode*>(image.data() + header.nodes_offset)};
+        auto branch_nodes {reinterpret_cast<node_id*>(image.data() + header.branch_nodes_offset)};
+        auto branch_keys {reinterpret_cast<T*>(image.data() + header.branch_keys_offset)};
+        auto letters_pool {reinterpret_cast<T*>(image.data() + header.letters_offset)};
+        std::uint32_t branches_pos {0}, letters_pos {0};
+        for (size_t node_count = 0; node_count < order.size(); ++node_count) {
+          const TreeNode<T>& node {arena[order[node_count]]};
+          auto letters {arena.letters(node)};
+          nodes[node_count] = {letters_pos, node.letters_len, branches_pos, node.branches_count,
+                               node.postfix_tree == no_node ? no_node : image_idx[node.postfix_tree], node.word};
+          letters_pos += static_cast<std::uint32_t>(ranges::copy(letters, letters_pool + letters_pos).out - (letters_pool + letters_pos));
+          arena.forBranches(node, [&](node_id branch) {
+            branch_keys[branches_pos] = arena[branch].key;
+            branch_nodes[branches_pos++] = image_idx[branch];
+          });
+        }
+        return image;
+      }
+
+      public :
+        ///  Creating an empty container
+        RadixTree () : root_branches{arena.make({})}{}
+        ///  Creating an empty container, all its memory is taken from an allocator
+        explicit RadixTree (const Alloc& alloc) : arena{alloc}, root_branches{arena.make({})}{}
+        ///  Creating a container with a single commands instance
+        RadixTree (vector<T> &&letters) : RadixTree(){ins(std::move(letters));}
+        ///  Creating a container with a list of instances
+        RadixTree (std::initializer_list<vector<T>> init): RadixTree() {ranges::for_each(init, [this](auto word){ins(std::move(word));});}
+        ///  Creating a container from sorted words in one pass, O(total words length). Words are sorted by keyLess of
+        ///  letter keys - std::sort of strings for character letters. Words out of order are still inserted but one by one
+        template <ranges::input_range R> requires WordOf<ranges::range_value_t<R>, T>
+        [[nodiscard]] static RadixTree build_sorted(R&& words) {
+          RadixTree tree;
+          tree.buildSorted(words);
+          return tree;
+        }
+        RadixTree (RadixTree&&) = default;
+        RadixTree& operator= (RadixTree&&) = default;
+        ~RadixTree () = default;
+        ///  Insert a new item to container
+        bool ins(vector<T> &&word) noexcept {return ins(span<const T>{word});}
+        ///  Insert a new item given as a span, string or string view
+        template <WordOf<T> W> bool ins(const W& word) noexcept {return countInsert(insWord(wordSpan<T>(word)) != no_node);}
+        ///  Insert many words by up to thread_count threads. Words are divided by leading letters (longer prefixes
+        ///  for skewed data), parts are built in parallel and joined. An empty tree with a stateless allocator
+        ///  is built in parallel, otherwise words are inserted one by one. Returns a number of inserted words
+        template <ranges::forward_range R> requires WordOf<ranges::range_value_t<R>, T> && std::is_lvalue_reference_v<ranges::range_reference_t<R>>
+        size_t bulk_insert(R&& words, size_t thread_count = std::thread::hardware_concurrency()) {
+          vector<span<const T>> letters;
+          for (const auto& word : words) {
+            letters.push_back(wordSpan<T>(word));
+          }
+          if (bulkSerial(letters.size(), thread_count)) {
+            return static_cast<size_t>(ranges::count_if(letters, [this](span<const T> word){return ins(word);}));
+          }
+          return bulkInsert<RadixTree>(std::move(letters), thread_count, [this]{return RadixTree(arena.get_allocator());},
+                                       [](RadixTree& sub, span<const T> word){return sub.insWord(word);},
+                                       [this](span<const T> word){return insWord(word);},
+                                       [](span<const T> word){return word.size();});
+        }
+        ///  Get an item from container
+        [[nodiscard]] unique_ptr<vector<T>> get(vector<T> const &&word) const noexcept {return get(span<const T>{word});}
+        ///  Get an item by a span, string or string view, the tree is walked without any copy of the word
+        template <WordOf<T> W> [[nodiscard]] unique_ptr<vector<T>> get(const W& word) const noexcept {
+          auto ret {make_unique<vector<T>>()};
+          if (!countLookup(getTree(root_branches, wordSpan<T>(word), *ret) != no_node)) {
+            ret.reset();
+          }
+          return ret;
+        }
+        ///  Get an item as spans over the word and node labels, nothing is allocated. See WordView
+        template <WordOf<T> W> [[nodiscard]] std::optional<WordView<T>> get_view(const W& word) const noexcept {
+          auto view {viewWord(arena, root_branches, wordSpan<T>(word))};
+          countLookup(view.has_value());
+          return view;
+        }
+        template <WordOf<T> W> requires (!ranges::borrowed_range<W> && !std::is_pointer_v<W>) void get_view(const W&& word) const = delete; //  A view would refer to a temporary word
+        ///  Write an item to an output iterator, nothing is allocated writing to a buffer of enough size. Returns an
+        ///  iterator past the item, nothing is written for a missing item
+        template <WordOf<T> W, std::output_iterator<const T&> Out> std::optional<Out> get_to(const W& word, Out out) const {
+          auto view {get_view(word)};
+          if (!view) {
+            return std::nullopt;
+          }
+          return view->copy(std::move(out));
+        }
+        ///  Check if exactly this item was inserted to container
+        template <WordOf<T> W> [[nodiscard]] bool contains(const W& word) const noexcept {
+          node_id node_idx {findWord(root_branches, wordSpan<T>(word))};
+          return countLookup(node_idx != no_node && arena[node_idx].word);
+        }
+        ///  Items within max_distance edits of a word, nearest first (items of the same distance in order of keys),
+        ///  up to limit ones. Only subtrees within the distance are visited
+        template <WordOf<T> W> [[nodiscard]] vector<FuzzyMatch<T>> fuzzy_get(const W& word, size_t max_distance, size_t limit = std::numeric_limits<size_t>::max()) const {
+          auto found {fuzzyFind(arena, root_branches, wordSpan<T>(word), max_distance)};
+          found.resize(std::min(found.size(), limit));
+          return found;
+        }
+        ///  Get many items at once, lookups are interleaved to hide memory latency. Results are set for
+        ///  min(words.size(), results.size()) words, returns number of found items
+        template <WordOf<T> W> size_t get_batch(span<const W> words, span<unique_ptr<vector<T>>> results) const noexcept {
+          size_t count {std::min(words.size(), results.size())};
+          vector<BatchWalk<T>> walks;
+          walks.reserve(count);
+          for (size_t pos = 0; pos < count; ++pos) {
+            walks.push_back({root_branches, wordSpan<T>(words[pos])});
+          }
+          walkTrees(arena, span<BatchWalk<T>>{walks});
+
+          size_t found {0};
+          for (size_t pos = 0; pos < count; ++pos) {
+            results[pos] = make_unique<vector<T>>();
+            if (completePos(arena, root_branches, walks[pos].word, walks[pos].pos, *results[pos]) == no_node) {
+              results[pos].reset();
+            } else {
+              ++found;
+            }
+          }
+          return found;
+        }
+        ///  Lazy range of up to limit items starting with a prefix, in order of keys
+        template <WordOf<T> W> [[nodiscard]] Completions<T, NodeArena<T, Alloc, Traits>> completions(const W& prefix, size_t limit = std::numeric_limits<size_t>::max()) const {
+          auto letters {wordSpan<T>(prefix)};
+          auto pos {goTree(root_branches, letters)};
+          if (!pos.found) {
+            return {};
+          }
+          return {arena, pos.node, letters.first(pos.depth), limit};
+        }
+        ///  Cursor for a word typed letter by letter, see Cursor
+        [[nodiscard]] Cursor<T, NodeArena<T, Alloc, Traits>> cursor() const noexcept {return {arena, root_branches};}
+        ///  Number of items starting with a prefix, O(prefix length) - every node keeps a number of words of its subtree
+        template <WordOf<T> W> [[nodiscard]] size_t count_prefix(const W& prefix) const noexcept {
+          auto pos {goTree(root_branches, wordSpan<T>(prefix))};
+          return pos.found ? arena[pos.node].items : 0;
+        }
+        ///  Exactly one item starts with a prefix
+        template <WordOf<T> W> [[nodiscard]] bool is_unique(const W& prefix) const noexcept {return count_prefix(prefix) == 1;}
+        ///  k-th (from 0) item starting with a prefix, the same as k-th one of completions. A page of a completion
+        ///  menu starts right there, O(depth * fan-out)
+        template <WordOf<T> W> [[nodiscard]] unique_ptr<vector<T>> kth(const W& prefix, size_t k) const {
+          auto letters {wordSpan<T>(prefix)};
+          auto pos {goTree(root_branches, letters)};
+          unique_ptr<vector<T>> ret;
+          if (pos.found) {
+            ret = make_unique<vector<T>>(letters.begin(), letters.begin() + pos.depth);
+            if (!kthItem(pos.node, k, *ret)) {
+              ret.reset();
+            }
+          }
+          return ret;
+        }
+        ///  Number of items ordered before a word (its position in completions of all items), the word could be absent
+        template <WordOf<T> W> [[nodiscard]] size_t rank(const W& word) const noexcept {return rankItem(root_branches, wordSpan<T>(word));}
+        ///  Remove all items, whole nodes storage is released at once
+        void clear() noexcept {
+          arena.clear();
+          root_branches = arena.make({});
+          shared_nodes = false;
+        }
+        ///  Move all words of another tree to the tree without inserting them again - paths of both trees are joined,
+        ///  labels are split only where they differ and subtrees missing here move as a whole. Returns a number of
+        ///  new words, the other tree is left empty
+        template <std::same_as<RadixTree> Other> size_t merge(Other&& other) {return mergeTree(other);}
+        ///  Erase an item. A node left with a single branch is joined with it, empty nodes and branches sets are released
+        template <WordOf<T> W> bool erase(const W& word) noexcept {
+          unshare();
+          return eraseTree(root_branches, wordSpan<T>(word), [this](node_id node_idx){return eraseWord(node_idx);});
+        }
+        ///  Rebuild nodes storage with reachable nodes only - labels and branches sets left by erases are dropped,
+        ///  branches sets get the smallest fitting kind
+        void compact() {
+          NodeArena<T, Alloc, Traits> fresh {arena.get_allocator()};
+          struct Copy {
+            node_id node;
+            node_id parent; //  Copy of a parent node
+            bool postfix; //  Node is a postfix tree root of a parent
+          };
+          vector<Copy> stack {{root_branches, no_node, false}};
+          while (!stack.empty()) {
+            Copy copy {stack.back()};
+            stack.pop_back();
+            const TreeNode<T>& node {arena[copy.node]};
+            node_id copy_idx {fresh.make(arena.letters(node))};
+            fresh[copy_idx].word = node.word;
+            fresh[copy_idx].items = node.items;
+            fresh[copy_idx].value = node.value;
+            if (copy.parent == no_node) {
+              root_branches = copy_idx;
+            } else if (copy.postfix) {
+              fresh[copy.parent].postfix_tree = copy_idx;
+            } else {
+              fresh.addBranch(copy.parent, copy_idx);
+            }
+            arena.forBranches(node, [&stack, copy_idx](node_id branch){stack.push_back({branch, copy_idx, false});});
+            if (node.postfix_tree != no_node) {
+              stack.push_back({node.postfix_tree, copy_idx, true});
+            }
+          }
+          arena = std::move(fresh);
+          shared_nodes = false;
+        }
+        ///  Keep equal subtrees once - postfix trees and branches of the same words and shape are shared, a tree becomes
+        ///  a DAWG (directed acyclic word graph) and nodes storage is rebuilt with distinct nodes only. Lookups give
+        ///  the same results, a next change copies shared nodes back (see compact). Returns a number of dropped nodes
+        size_t minimize() {
+          //  Children go before parents, a node is the same as an earlier one of the same label, word mark and
+          //  the same (shared already) postfix tree and branches
+          vector<node_id> order {root_branches};
+          for (size_t pos = 0; pos < order.size(); ++pos) {
+            const TreeNode<T>& node {arena[order[pos]]};
+            arena.forBranches(node, [&order](node_id branch){order.push_back(branch);});
+            if (node.postfix_tree != no_node) {
+              order.push_back(node.postfix_tree);
+            }
+          }
+          struct Shape {
+            span<const T> letters;
+            bool word;
+            node_id postfix;
+            vector<node_id> branches;
+            bool operator== (const Shape& other) const {
+              return word == other.word && postfix == other.postfix && branches == other.branches && ranges::equal(letters, other.letters);
+            }
+          };
+          auto hash_shape = [](const Shape& shape) {
+            size_t hash {std::hash<node_id>{}(shape.postfix) ^ shape.word};
+            auto mix = [&hash](size_t value){hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);};
+            ranges::for_each(shape.letters, [&mix](const T& letter){mix(std::hash<T>{}(letter));});
+            ranges::for_each(shape.branches, [&mix](node_id branch){mix(branch);});
+            return hash;
+          };
+          std::unordered_map<Shape, node_id, decltype(hash_shape)> shapes(order.size(), hash_shape);
+          vector<node_id> same(arena.size(), no_node);
+          for (auto node_it = order.rbegin(); node_it != order.rend(); ++node_it) {
+            const TreeNode<T>& node {arena[*node_it]};
+            Shape shape {arena.letters(node), node.word, node.postfix_tree == no_node ? no_node : same[node.postfix_tree], {}};
+            arena.forBranches(node, [this, &shape, &same](node_id branch){shape.branches.push_back(same[branch]);});
+            same[*node_it] = shapes.try_emplace(std::move(shape), *node_it).first->second;
+          }
+
+          //  Copy of distinct nodes, every copy is made once and linked to all its parents
+          NodeArena<T, Alloc, Traits> fresh {arena.get_allocator()};
+          vector<node_id> copies(arena.size(), no_node);
+          struct Copy {
+            node_id node;
+            node_id parent; //  Copy of a parent node
+            bool postfix; //  Node is a postfix tree root of a parent
+          };
+          vector<Copy> stack {{root_branches, no_node, false}};
+          while (!stack.empty()) {
+            Copy copy {stack.back()};
+            stack.pop_back();
+            const node_id node_idx {same[copy.node]};
+            node_id copy_idx {copies[node_idx]};
+            if (copy_idx == no_node) {
+              const TreeNode<T>& node {arena[node_idx]};
+              copy_idx = copies[node_idx] = fresh.make(arena.letters(node));
+              fresh[copy_idx].word = node.word;
+              fresh[copy_idx].items = node.items;
+              fresh[copy_idx].value = node.value;
+              arena.forBranches(node, [&stack, copy_idx](node_id branch){stack.push_back({branch, copy_idx, false});});
+              if (node.postfix_tree != no_node) {
+                stack.push_back({node.postfix_tree, copy_idx, true});
+              }
+            }
+            if (copy.parent == no_node) {
+              root_branches = copy_idx;
+            } else if (copy.postfix) {
+              fresh[copy.parent].postfix_tree = copy_idx;
+            } else {
+              fresh.addBranch(copy.parent, copy_idx);
+            }
+          }
+          const size_t dropped {order.size() - shapes.size()};
+          arena = std::move(fresh);
+          shared_nodes = dropped != 0;
+          return dropped;
+        }
+        ///  Shape and memory of a tree - nodes, depth and fan-out distributions, bytes of labels, branches and nodes
+        [[nodiscard]] TreeStats stats() const {
+          TreeStats stats;
+          vector<pair<node_id, size_t>> stack {{root_branches, 0}};
+          vector<bool> seen(shared_nodes ? arena.size() : 0);
+          while (!stack.empty()) {
+            auto [node_idx, depth] {stack.back()};
+            stack.pop_back();
+            if (shared_nodes) {
+              if (seen[node_idx]) {
+                continue; //  Shared node of a minimized tree is counted once
               }
+              seen[node_idx] = true;
+            }
+            const TreeNode<T>& node {arena[node_idx]};
+            ++stats.nodes;
+            stats.words += node.word;
+            stats.max_depth = std::max(stats.max_depth, depth);
+            stats.depth_nodes.resize(std::max(stats.depth_nodes.size(), depth + 1));
+            ++stats.depth_nodes[depth];
+            stats.max_fanout = std::max<size_t>(stats.max_fanout, node.branches_count);
+            stats.fanout_nodes.resize(std::max<size_t>(stats.fanout_nodes.size(), node.branches_count + 1));
+            ++stats.fanout_nodes[node.branches_count];
+            ++stats.kind_nodes[static_cast<size_t>(node.branches_kind)];
+            arena.forBranches(node, [&stack, depth](node_id branch){stack.emplace_back(branch, depth + 1);});
+            if (node.postfix_tree != no_node) {
+              ++stats.postfix_trees;
+              stack.emplace_back(node.postfix_tree, depth + 1);
             }
           }
+          arena.memory(stats);
+          return stats;
+        }
+        ///  Operation counters, all zero unless built with CLIDICT_STATS
+        [[nodiscard]] OpCounters counters() const noexcept {
+          OpCounters counters {};
+          CLIDICT_STAT(counters = op_counters;)
+          counters.levels = arena.branchLookups();
+          return counters;
+        }
+        ///  Compile container to a read only image, see FrozenTree. Images compare letters as they are, so a tree of
+        ///  other letter traits is not compiled
+        [[nodiscard]] vector<std::byte> freeze() const requires plain_traits<Traits, T> {return freezeTree(0, T{});}
+        ///  Compile container and write the image to a file
+        bool save(const std::filesystem::path& path) const requires plain_traits<Traits, T> {return saveImage(path, freeze());}
+  };
+
+  ///  Payloads of map words, slots of erased words are reused
+  template <typename V, typename Alloc> struct ValuePool {
+    vector<std::optional<V>, Rebind<Alloc, std::optional<V>>> slots;
+    vector<std::uint32_t, Rebind<Alloc, std::uint32_t>> released;
+
+    explicit ValuePool(const Alloc& alloc) : slots(alloc), released(alloc) {}
+    std::uint32_t make(V&& value) {
+      if (released.empty()) {
+        slots.emplace_back(std::move(value));
+        return static_cast<std::uint32_t>(slots.size() - 1);
+      }
+      std::uint32_t slot {released.back()};
+      released.pop_back();
+      slots[slot].emplace(std::move(value));
+      return slot;
+    }
+    void release(std::uint32_t slot) {
+      slots[slot].reset();
+      released.push_back(slot);
+    }
+    void clear() noexcept {
+      slots.clear();
+      released.clear();
+    }
+  };
+
+  ///  Radix tree with a payload (a command handler) for every word. An abbreviated word is resolved and its
+  ///  payload is found in one descent, no completion is made
+  template <typename T, typename V, typename Alloc = std::allocator<T>> class RadixMap : public RadixTree<T, Alloc> {
+    private :
+      ValuePool<V, Alloc> values;
+
+      //  Payload of a word node, nullptr for a node not ending a word
+      const V* nodeValue(node_id node_idx) const noexcept {
+        const TreeNode<T>& node {this->arena[node_idx]};
+        return node.word ? &*values.slots[node.value] : nullptr;
+      }
+    public :
+      ///  Creating an empty map
+      RadixMap () : values{Alloc()} {}
+      ///  Creating an empty map, all its memory is taken from an allocator
+      explicit RadixMap (const Alloc& alloc) : RadixTree<T, Alloc>(alloc), values{alloc} {}
+      ///  Creating a map with a list of words and payloads
+      RadixMap (std::initializer_list<pair<vector<T>, V>> init) : RadixMap() {
+        for (const auto& [word, value] : init) {
+          ins(word, value);
+        }
+      }
+      ///  Payloads are not moved by merge of trees
+      template <typename Other> size_t merge(Other&& other) = delete;
+      ///  Words of bulk_insert would have no payloads
+      template <typename R> size_t bulk_insert(R&& words, size_t thread_count = 0) = delete;
+      ///  Words of different payloads are not the same
+      size_t minimize() = delete;
+      ///  Insert a new word with a payload, a payload of a word in the map already is not changed
+      template <WordOf<T> W> bool ins(const W& word, V value) {
+        node_id node_idx {this->insWord(wordSpan<T>(word))};
+        if (node_idx == no_node) {
+          return this->countInsert(false);
+        }
+        this->arena[node_idx].value = values.make(std::move(value));
+        return this->countInsert(true);
+      }
+      ///  Payload of a word an abbreviation is completed to (the same one get gives), nullptr if the completion
+      ///  is not a word. A single descent - no completion is made
+      template <WordOf<T> W> [[nodiscard]] V* find(const W& abbrev) noexcept {return const_cast<V*>(std::as_const(*this).find(abbrev));}
+      template <WordOf<T> W> [[nodiscard]] const V* find(const W& abbrev) const noexcept {
+        auto pos {this->goTree(this->root_branches, wordSpan<T>(abbrev))};
+        const V* value {pos.found && pos.node != this->root_branches ? nodeValue(pos.node) : nullptr};
+        this->countLookup(value != nullptr);
+        return value;
+      }
+      ///  Payload of exactly this word, nullptr if the word is not in the map
+      template <WordOf<T> W> [[nodiscard]] V* find_exact(const W& word) noexcept {return const_cast<V*>(std::as_const(*this).find_exact(word));}
+      template <WordOf<T> W> [[nodiscard]] const V* find_exact(const W& word) const noexcept {
+        node_id node_idx {this->findWord(this->root_branches, wordSpan<T>(word))};
+        const V* value {node_idx == no_node ? nullptr : nodeValue(node_idx)};
+        this->countLookup(value != nullptr);
+        return value;
+      }
+      ///  Erase a word with its payload
+      template <WordOf<T> W> bool erase(const W& word) noexcept {
+        node_id node_idx {this->findWord(this->root_branches, wordSpan<T>(word))};
+        if (node_idx == no_node || !this->arena[node_idx].word) {
+          return false;
+        }
+        values.release(std::exchange(this->arena[node_idx].value, no_node));
+        return RadixTree<T, Alloc>::erase(word);
+      }
+      ///  Remove all words and payloads
+      void clear() noexcept {
+        RadixTree<T, Alloc>::clear();
+        values.clear();
+      }
+  };
+
+  ///  Read only radix tree working straight on a compiled image (RadixTree::freeze), the image should outlive the tree.
+  ///  Opening is O(1) - memory mapped image file (MappedImage) is used as is and shared by all processes
+  template <typename T> class FrozenTree {
+    protected :
+      ImageView<T> view;
+
+      FrozenTree (span<const std::byte> image, std::uint32_t flags) noexcept : view{image} {
+        if (view.head() && view.head()->flags != flags) {
+          view = ImageView<T>{};
+        }
+      }
+    public :
+      ///  Empty tree
+      FrozenTree () = default;
+      ///  Tree of a compiled RadixTree image
+      explicit FrozenTree (span<const std::byte> image) noexcept : FrozenTree(image, 0) {}
+      ///  Image is bound
+      [[nodiscard]] bool valid() const noexcept {return view.head();}
+      ///  Get an item from container
+      template <WordOf<T> W> [[nodiscard]] unique_ptr<vector<T>> get(const W& word) const noexcept {
+        unique_ptr<vector<T>> ret;
+        if (valid()) {
+          ret = make_unique<vector<T>>();
+          if (completeWord(view, view.head()->root, wordSpan<T>(word), *ret) == no_node) {
+            ret.reset();
+          }
         }
         return ret;
       }
+      ///  Check if exactly this item is in container
+      template <WordOf<T> W> [[nodiscard]] bool contains(const W& word) const noexcept {
+        if (!valid()) {
+          return false;
+        }
+        node_id node_idx {findWord(view, view.head()->root, wordSpan<T>(word))};
+        return node_idx != no_node && view.word(node_idx);
+      }
+  };
+
+  ///  Node of a StaticTree. A path from a root to a node is a prefix of one of sorted words, so a node keeps
+  ///  its path position in the letters and a label is just the path end
+  struct StaticNode {
+    std::uint32_t path_pos {0}; //  Path start in the letters
+    std::uint32_t path_len {0};
+    std::uint32_t label_pos {0}; //  Label start inside of the path
+    std::uint32_t branches_pos {0}; //  First branch in the branch arrays, branches are sorted by keys
+    std::uint32_t branches_count {0};
+    bool word {false};
+  };
+
+  template <typename T> class StaticBuilder;
+
+  ///  Read only tree built at compile time (makeStaticTree) - nodes, branches and letters are arrays in static
+  ///  storage, there is nothing to build at startup and lookups make no heap allocations
+  template <typename T, size_t Nodes, size_t Letters> class StaticTree {
+    private :
+      std::array<StaticNode, Nodes> nodes {};
+      std::array<T, Nodes> branch_keys {};
+      std::array<node_id, Nodes> branch_nodes {};
+      std::array<T, Letters> path_letters {};
+
+      friend class StaticBuilder<T>;
+      static constexpr node_id root {0};
+
+      //  Full path of a node
+      constexpr span<const T> path(node_id id) const noexcept {return {path_letters.data() + nodes[id].path_pos, nodes[id].path_len};}
+    public :
+      //  Tree store - see walkTree
+      constexpr span<const T> letters(node_id id) const noexcept {return path(id).subspan(nodes[id].label_pos);}
+      constexpr node_id branch(node_id id, const T& key) const noexcept {
+        auto keys_begin {branch_keys.begin() + nodes[id].branches_pos};
+        auto keys_end {keys_begin + nodes[id].branches_count};
+        auto key_it {std::lower_bound(keys_begin, keys_end, key, keyLess<T>)};
+        return key_it != keys_end && *key_it == key ? branch_nodes[key_it - branch_keys.begin()] : no_node;
+      }
+      constexpr node_id postfix(node_id) const noexcept {return no_node;}
+      constexpr bool word(node_id id) const noexcept {return nodes[id].word;}
+      template <typename F> constexpr void forBranches(node_id id, F&& fn) const {
+        for (std::uint32_t pos = 0; pos < nodes[id].branches_count; ++pos) {
+          fn(branch_nodes[nodes[id].branches_pos + pos]);
+        }
+      }
+
+      ///  Get an item - a word with a rest of a last node, as a view of the static letters. Empty if there is no item
+      template <WordOf<T> W> [[nodiscard]] constexpr span<const T> get(const W& word) const noexcept {
+        auto letters {wordSpan<T>(word)};
+        auto pos {walkTree(*this, root, letters)};
+        if (!pos.found || pos.node == root) {
+          return {};
+        }
+        return path(pos.node);
+      }
+      ///  Check if exactly this item is in container
+      template <WordOf<T> W> [[nodiscard]] constexpr bool contains(const W& word) const noexcept {
+        node_id node_idx {findWord(*this, root, wordSpan<T>(word))};
+        return node_idx != no_node && nodes[node_idx].word;
+      }
+      ///  Lazy range of up to limit items starting with a prefix, in order of keys
+      template <WordOf<T> W> [[nodiscard]] Completions<T, StaticTree> completions(const W& prefix, size_t limit = std::numeric_limits<size_t>::max()) const {
+        auto letters {wordSpan<T>(prefix)};
+        auto pos {walkTree(*this, root, letters)};
+        if (!pos.found) {
+          return {};
+        }
+        return {*this, pos.node, letters.first(pos.depth), limit};
+      }
+      ///  Number of nodes, root included
+      static constexpr size_t size() noexcept {return Nodes;}
+  };
+
+  ///  Compile time builder of a StaticTree. Words are sorted, a node covers a range of words with a common prefix
+  template <typename T> class StaticBuilder {
+    private :
+      vector<std::basic_string_view<T>> words;
+      vector<std::uint32_t> offsets; //  Word positions in the letters
+
+      //  Build nodes of a words range in depth first order, tree is nullptr for counting nodes only
+      template <typename Tree> constexpr node_id build(Tree tree, size_t lo, size_t hi, size_t label_pos, node_id& next_node, size_t& next_branch) const {
+        node_id id {next_node++};
+        size_t end {0};
+        if (id != 0) {
+          end = commonPrefix<T>(words[lo], words[hi - 1]);
+        }
+        StaticNode node {offsets[lo], static_cast<std::uint32_t>(end), static_cast<std::uint32_t>(label_pos)};
+        if (id != 0 && words[lo].size() == end) {
+          node.word = true;
+          ++lo;
+        }
+
+        //  Words with the same letter after the common prefix go to one branch
+        size_t groups {0};
+        for (size_t pos = lo; pos < hi; ++pos) {
+          groups += pos == lo || words[pos][end] != words[pos - 1][end];
+        }
+        node.branches_pos = static_cast<std::uint32_t>(next_branch);
+        node.branches_count = static_cast<std::uint32_t>(groups);
+        next_branch += groups;
+        size_t branch {node.branches_pos};
+        for (size_t group_lo = lo; group_lo < hi; ++branch) {
+          size_t group_hi {group_lo + 1};
+          while (group_hi < hi && words[group_hi][end] == words[group_lo][end]) {
+            ++group_hi;
+          }
+          node_id branch_node {build(tree, group_lo, group_hi, end, next_node, next_branch)};
+          if constexpr (!std::is_same_v<Tree, std::nullptr_t>) {
+            tree->branch_keys[branch] = words[group_lo][end];
+            tree->branch_nodes[branch] = branch_node;
+          }
+          group_lo = group_hi;
+        }
+        if constexpr (!std::is_same_v<Tree, std::nullptr_t>) {
+          tree->nodes[id] = node;
+        }
+        return id;
+      }
+    public :
+      template <typename R> constexpr explicit StaticBuilder(const R& list) {
+        for (const auto& word : list) {
+          std::basic_string_view<T> view {word};
+          if (!view.empty()) {
+            words.push_back(view);
+          }
+        }
+        std::sort(words.begin(), words.end());
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+        offsets.push_back(0);
+        for (const auto& word : words) {
+          offsets.push_back(static_cast<std::uint32_t>(offsets.back() + word.size()));
+        }
+      }
+      constexpr size_t letters() const noexcept {return offsets.back();}
+      constexpr size_t nodes() const {
+        node_id next_node {0};
+        size_t next_branch {0};
+        build(nullptr, 0, words.size(), 0, next_node, next_branch);
+        return next_node;
+      }
+      template <size_t Nodes, size_t Letters> constexpr void fill(StaticTree<T, Nodes, Letters>& tree) const {
+        node_id next_node {0};
+        size_t next_branch {0};
+        build(&tree, 0, words.size(), 0, next_node, next_branch);
+        for (size_t pos = 0; pos < words.size(); ++pos) {
+          std::copy(words[pos].begin(), words[pos].end(), tree.path_letters.begin() + offsets[pos]);
+        }
+      }
+  };
+
+  ///  Build a StaticTree at compile time from a function returning a list of words (strings views or string literals):
+  ///  static constexpr auto commands {makeStaticTree<[]{return std::array{"test1", "test2"};}>()};
+  template <auto words, typename T = typename decltype(std::basic_string_view{*std::begin(words())})::value_type>
+  consteval auto makeStaticTree() {
+    constexpr size_t nodes_count {StaticBuilder<T>{words()}.nodes()};
+    constexpr size_t letters_count {StaticBuilder<T>{words()}.letters()};
+    StaticTree<T, nodes_count, letters_count> tree;
+    StaticBuilder<T>{words()}.fill(tree);
+    return tree;
+  }
+
+  ///  Epoch based reclamation for concurrent trees. Readers only bump a counter of their current epoch (wait-free),
+  ///  a writer flips the epoch twice and waits till readers of the old epochs are gone - nodes replaced before are not
+  ///  seen by anybody after that
+  class EpochDomain {
+    private :
+      static constexpr size_t slots_count {64};
+      struct alignas(64) Slot {
+        std::atomic<std::uint64_t> readers[2] {};
+      };
+      std::atomic<std::uint64_t> epoch {0};
+      Slot slots[slots_count];
+
+      static size_t readerSlot() noexcept {
+        static std::atomic<size_t> next_slot {0};
+        thread_local const size_t slot {next_slot.fetch_add(1, std::memory_order_relaxed) % slots_count};
+        return slot;
+      }
+    public :
+      ///  Reader section, nodes seen inside of it are not released
+      class Guard {
+        private :
+          std::atomic<std::uint64_t>* readers;
+        public :
+          explicit Guard (EpochDomain& domain) noexcept {
+            auto parity {domain.epoch.load(std::memory_order_acquire) & 1};
+            readers = &domain.slots[readerSlot()].readers[parity];
+            readers->fetch_add(1, std::memory_order_seq_cst);
+          }
+          Guard (const Guard&) = delete;
+          Guard& operator= (const Guard&) = delete;
+          ~Guard () {readers->fetch_sub(1, std::memory_order_release);}
+      };
+      ///  Wait till all readers started before the call are gone
+      void synchronize() noexcept {
+        for (int flip = 0; flip < 2; ++flip) {
+          auto parity {epoch.fetch_add(1, std::memory_order_seq_cst) & 1};
+          for (auto& slot : slots) {
+            //  seq_cst pairs with a reader counter increment followed by a root load, a reader of an old root is not missed
+            while (slot.readers[parity].load(std::memory_order_seq_cst)) {
+              std::this_thread::yield();
+            }
+          }
+        }
+      }
+  };
+
+  ///  Node of a concurrent tree, never changed while it could be seen by readers
+  template <typename T> struct CowNode {
+    vector<T> letters;
+    vector<T> keys; //  Sorted branch keys
+    vector<node_id> branches;
+    node_id postfix_tree {no_node};
+    bool word {false};
+  };
+
+  ///  Nodes storage of a concurrent tree. Blocks directory has a fixed size, so nodes never move and readers
+  ///  never see a directory change. Only a writer makes and releases nodes
+  template <typename T> class CowStore {
+    private :
+      static constexpr size_t block_bits {12};
+      static constexpr size_t block_size {size_t{1} << block_bits};
+      static constexpr size_t directory_size {16384};
+      unique_ptr<unique_ptr<CowNode<T>[]>[]> blocks {make_unique<unique_ptr<CowNode<T>[]>[]>(directory_size)};
+      size_t nodes_count {0};
+      vector<node_id> released;
+    public :
+      ///  Nodes could be made yet
+      size_t available() const noexcept {return directory_size * block_size - nodes_count + released.size();}
+      node_id make(CowNode<T>&& node) {
+        node_id id;
+        if (!released.empty()) {
+          id = released.back();
+          released.pop_back();
+        } else {
+          if (nodes_count % block_size == 0) {
+            blocks[nodes_count >> block_bits] = make_unique<CowNode<T>[]>(block_size);
+          }
+          id = static_cast<node_id>(nodes_count++);
+        }
+        blocks[id >> block_bits][id & (block_size - 1)] = std::move(node);
+        return id;
+      }
+      ///  Release a node nobody could see anymore
+      void release(node_id id) {
+        blocks[id >> block_bits][id & (block_size - 1)] = CowNode<T>{};
+        released.push_back(id);
+      }
+      const CowNode<T>& operator[](node_id id) const noexcept {return blocks[id >> block_bits][id & (block_size - 1)];}
+      span<const T> letters(node_id id) const noexcept {return (*this)[id].letters;}
+      node_id branch(node_id id, const T& key) const noexcept {
+        const auto& keys {(*this)[id].keys};
+        auto key_it {std::lower_bound(keys.begin(), keys.end(), key, keyLess<T>)};
+        return key_it != keys.end() && *key_it == key ? (*this)[id].branches[key_it - keys.begin()] : no_node;
+      }
+      node_id postfix(node_id id) const noexcept {return (*this)[id].postfix_tree;}
+      bool word(node_id id) const noexcept {return (*this)[id].word;}
+      template <typename F> void forBranches(node_id id, F&& fn) const {ranges::for_each((*this)[id].branches, fn);}
+  };
+
+  ///  Radix tree shared by many threads. Readers walk the tree wait-free and are never blocked by writers, ins copies nodes
+  ///  of a changed path and publishes a new root atomically, old nodes are released when no reader could see them.
+  ///  Writers are serialized
+  template <typename T> class ConcurrentRadixTree {
+    protected :
+      CowStore<T> store;
+      std::atomic<node_id> root;
+      mutable EpochDomain epochs;
+      std::mutex writer;
+      vector<node_id> retired;  //  Replaced nodes waiting for readers to leave
+      static constexpr size_t reclaim_batch {1024};
+
+      //  New node with a word and a postfix tree with a post part word at the word end
+      node_id makeLeaf(span<const T> word, span<const T> post) {
+        CowNode<T> leaf;
+        leaf.letters.assign(word.begin(), word.end());
+        if (post.empty()) {
+          leaf.word = true;
+        } else {
+          leaf.postfix_tree = makeTree(post);
+        }
+        return store.make(std::move(leaf));
+      }
+      //  New tree with a single word
+      node_id makeTree(span<const T> word) {
+        CowNode<T> tree_root;
+        tree_root.keys.push_back(word.front());
+        tree_root.branches.push_back(makeLeaf(word, {}));
+        return store.make(std::move(tree_root));
+      }
+      //  Put a branch to a node copy keeping keys sorted
+      static void addBranch(CowNode<T>& node, const T& key, node_id branch) {
+        auto key_it {std::lower_bound(node.keys.begin(), node.keys.end(), key, keyLess<T>)};
+        node.branches.insert(node.branches.begin() + (key_it - node.keys.begin()), branch);
+        node.keys.insert(key_it, key);
+      }
+      //  Copy of a node with a word added below the node label (and a post part word to a postfix tree at the word end).
+      //  Returns the same node if the word is already there, nodes replaced by copies go to retired
+      node_id insCopy(node_id node_idx, span<const T> word, span<const T> post, vector<node_id>& replaced) {
+        CowNode<T> copy {store[node_idx]};
+
+        if (word.empty()) {
+          //  Word ends exactly at the node
+          if (post.empty()) {
+            if (copy.word) {
+              return node_idx;
+            }
+            copy.word = true;
+          } else if (copy.postfix_tree == no_node) {
+            copy.postfix_tree = makeTree(post);
+          } else {
+            node_id postfix_root {insCopy(copy.postfix_tree, post, {}, replaced)};
+            if (postfix_root == copy.postfix_tree) {
+              return node_idx;
+            }
+            copy.postfix_tree = postfix_root;
+          }
+        } else if (auto key_it {std::lower_bound(copy.keys.begin(), copy.keys.end(), word.front(), keyLess<T>)}; key_it == copy.keys.end() || *key_it != word.front()) {
+          //  Just add a rest of a word to a new branch
+          addBranch(copy, word.front(), makeLeaf(word, post));
+        } else {
+          node_id& branch {copy.branches[key_it - copy.keys.begin()]};
+          const CowNode<T>& branch_node {store[branch]};
+          size_t common {commonPrefix<T>(branch_node.letters, word)};
+          if (common == branch_node.letters.size()) {
+            node_id new_branch {insCopy(branch, word.subspan(common), post, replaced)};
+            if (new_branch == branch) {
+              return node_idx;
+            }
+            branch = new_branch;
+          } else {
+            //  Word differs in the middle of a branch label - dividing a copy of the branch
+            CowNode<T> middle;
+            middle.letters.assign(branch_node.letters.begin(), branch_node.letters.begin() + common);
+            CowNode<T> rest {branch_node};
+            rest.letters.erase(rest.letters.begin(), rest.letters.begin() + common);
+            T rest_key {rest.letters.front()};
+            addBranch(middle, rest_key, store.make(std::move(rest)));
+            if (common == word.size()) {
+              if (post.empty()) {
+                middle.word = true;
+              } else {
+                middle.postfix_tree = makeTree(post);
+              }
+            } else {
+              addBranch(middle, word[common], makeLeaf(word.subspan(common), post));
+            }
+            replaced.push_back(branch);
+            branch = store.make(std::move(middle));
+          }
+        }
+        replaced.push_back(node_idx);
+        return store.make(std::move(copy));
+      }
+      //  Wait for readers and release replaced nodes, writer lock is held
+      void reclaimRetired() {
+        epochs.synchronize();
+        ranges::for_each(retired, [this](node_id node_idx){store.release(node_idx);});
+        retired.clear();
+      }
+      //  Insert a word and a post part word under the writer lock and publish a new root. Old nodes are released
+      //  by batches, so a writer waits for readers once per many inserts. Throws std::length_error if the nodes
+      //  storage is full
+      bool insPublish(span<const T> word, span<const T> post) {
+        std::lock_guard lock {writer};
+        if (store.available() < 2 * (word.size() + post.size()) + 8) {
+          reclaimRetired();
+          if (store.available() < 2 * (word.size() + post.size()) + 8) {
+            throw std::length_error{"concurrent tree nodes storage is full"};
+          }
+        }
+        node_id old_root {root.load(std::memory_order_relaxed)};
+        node_id new_root {insCopy(old_root, word, post, retired)};
+        if (new_root == old_root) {
+          return false;
+        }
+        root.store(new_root, std::memory_order_seq_cst);
+        if (retired.size() >= reclaim_batch) {
+          reclaimRetired();
+        }
+        return true;
+      }
+    public :
+      ///  Creating an empty container
+      ConcurrentRadixTree () : root{store.make({})} {}
+      ///  Creating a container with a list of instances
+      ConcurrentRadixTree (std::initializer_list<vector<T>> init) : ConcurrentRadixTree() {ranges::for_each(init, [this](const auto& word){ins(word);});}
+      ///  Insert a new item, readers are not blocked. Returns false for an item in the container already, throws
+      ///  std::length_error if the nodes storage is full
+      template <WordOf<T> W> bool ins(const W& word) {
+        auto letters {wordSpan<T>(word)};
+        return !letters.empty() && insPublish(letters, {});
+      }
+      ///  Release memory of all replaced nodes now, waits for current readers
+      void reclaim() {
+        std::lock_guard lock {writer};
+        reclaimRetired();
+      }
+      ///  Get an item from container, the tree walk is wait-free but the result is allocated
+      template <WordOf<T> W> [[nodiscard]] unique_ptr<vector<T>> get(const W& word) const {
+        auto ret {make_unique<vector<T>>()};
+        EpochDomain::Guard guard {epochs};
+        if (completeWord(store, root.load(std::memory_order_seq_cst), wordSpan<T>(word), *ret) == no_node) {
+          ret.reset();
+        }
+        return ret;
+      }
+      ///  Write an item to an output iterator, wait-free - nothing is allocated writing to a buffer of enough size.
+      ///  Returns an iterator past the item, nothing is written for a missing item
+      template <WordOf<T> W, std::output_iterator<const T&> Out> std::optional<Out> get_to(const W& word, Out out) const {
+        EpochDomain::Guard guard {epochs};
+        auto view {viewWord(store, root.load(std::memory_order_seq_cst), wordSpan<T>(word))};
+        if (!view) {
+          return std::nullopt;
+        }
+        return view->copy(std::move(out));
+      }
+      ///  Check if exactly this item is in container, wait-free
+      template <WordOf<T> W> [[nodiscard]] bool contains(const W& word) const noexcept {
+        EpochDomain::Guard guard {epochs};
+        node_id node_idx {findWord(store, root.load(std::memory_order_seq_cst), wordSpan<T>(word))};
+        return node_idx != no_node && store.word(node_idx);
+      }
+  };
+
+#if __has_include(<sys/mman.h>)
+  ///  Read only memory mapped image file. Pages are loaded on demand and shared by all processes mapping the same file.
+  ///  A file that is not a whole valid image (validImage) is not mapped
+  class MappedImage {
+    private :
+      void* data {nullptr};
+      size_t size {0};
+    public :
+      MappedImage () = default;
+      explicit MappedImage (const std::filesystem::path& path) noexcept {
+        int file {::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+        if (file < 0) {
+          return;
+        }
+        struct stat file_stat {};
+        if (::fstat(file, &file_stat) == 0 && file_stat.st_size > 0) {
+          if (void* map {::mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_SHARED, file, 0)}; map != MAP_FAILED) {
+            data = map;
+            size = static_cast<size_t>(file_stat.st_size);
+          }
+        }
+        ::close(file);
+        //  A file could be truncated or damaged, its nodes are checked once here and not on every lookup
+        if (data && !validImage(bytes())) {
+          ::munmap(data, size);
+          data = nullptr;
+          size = 0;
+        }
+      }
+      MappedImage (MappedImage&& other) noexcept : data{std::exchange(other.data, nullptr)}, size{std::exchange(other.size, 0)} {}
+      MappedImage& operator= (MappedImage&& other) noexcept {
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        return *this;
+      }
+      ~MappedImage () {
+        if (data) {
+          ::munmap(data, size);
+        }
+      }
+      ///  File is mapped
+      explicit operator bool() const noexcept {return data;}
+      ///  Mapped file bytes
+      span<const std::byte> bytes() const noexcept {return {static_cast<const std::byte*>(data), size};}
+  };
+#endif
+
+  ///  Containers with all memory taken from a std::pmr::memory_resource
+  namespace pmr {
+    template <typename T> using RadixTree = radix_dict::RadixTree<T, std::pmr::polymorphic_allocator<T>>;
+    template <typename T, typename V> using RadixMap = radix_dict::RadixMap<T, V, std::pmr::polymorphic_allocator<T>>;
+  }
+}
+
+namespace cli_dict {
+  template <typename T> using Leaf = radix_dict::TreeNode<T>;
+  template <typename T, typename Alloc = std::allocator<T>, typename Traits = radix_dict::LetterTraits<T>> using Node = radix_dict::RadixTree<T, Alloc, Traits>;
+  using radix_dict::node_id;
+  using radix_dict::no_node;
+
+  ///  Word parts divided by a first delimiter
+  template <typename T> struct Parts {
+    span<const T> pre;
+    span<const T> post {};
+    bool postfix {false}; //  Word has a delimiter
+  };
+  template <typename T> Parts<T> divide(span<const T> word, const T& delim) noexcept {
+    auto delim_it {ranges::find(word, delim)};
+    if (delim_it == word.end()) {
+      return {word};
+    }
+    size_t delim_pos = delim_it - word.begin();
+    return {word.first(delim_pos), word.subspan(delim_pos + 1), true};
+  }
+
+  ///  Dictionary item completion - pre part completion, delimiter and post part completion
+  template <typename T, typename Store> unique_ptr<vector<T>> completeItem(const Store& store, node_id root, const T& delim, span<const T> word) {
+    auto parts {divide(word, delim)};
+    auto ret {make_unique<vector<T>>()};
+
+    //  Check data
+    if (parts.pre.empty()) {
+      ret.reset();
+      return ret;
+    }
+
+    node_id node_idx {radix_dict::completeWord(store, root, parts.pre, *ret)};
+    if (node_idx == no_node) {
+      ret.reset();
+    } else if (parts.postfix) {
+      ret->push_back(delim);
+      if (!parts.post.empty()) {
+        node_id postfix_root {store.postfix(node_idx)};
+        if (postfix_root == no_node || radix_dict::completeWord(store, postfix_root, parts.post, *ret) == no_node) {
+          ret.reset();
+        }
+      }
+    }
+    return ret;
+  }
+  ///  Dictionary item completion as a view, see completeItem
+  template <typename T, typename Store> std::optional<radix_dict::WordView<T>> viewItem(const Store& store, node_id root, const T& delim, span<const T> word) noexcept {
+    auto parts {divide(word, delim)};
+    if (parts.pre.empty()) {
+      return std::nullopt;
+    }
+    auto pos {radix_dict::walkTree(store, root, parts.pre)};
+    auto view {radix_dict::viewPos(store, root, parts.pre, pos)};
+    if (view && parts.postfix) {
+      view->delim = delim;
+      if (!parts.post.empty()) {
+        node_id postfix_root {store.postfix(pos.node)};
+        auto post {postfix_root == no_node ? std::nullopt : radix_dict::viewWord(store, postfix_root, parts.post)};
+        if (!post) {
+          return std::nullopt;
+        }
+        view->post_typed = post->typed;
+        view->post_rest = post->rest;
+      }
+    }
+    return view;
+  }
+  ///  Node where exactly this dictionary item ends, the node could be not an item end (word flag)
+  template <typename T, typename Store> node_id findItem(const Store& store, node_id root, const T& delim, span<const T> word) noexcept {
+    auto parts {divide(word, delim)};
+    if (parts.pre.empty()) {
+      return no_node;
+    }
+    node_id node_idx {radix_dict::findWord(store, root, parts.pre)};
+    if (node_idx != no_node && !parts.post.empty()) {
+      node_id postfix_root {store.postfix(node_idx)};
+      node_idx = postfix_root == no_node ? no_node : radix_dict::findWord(store, postfix_root, parts.post);
+    }
+    return node_idx;
+  }
+  ///  Check if exactly this dictionary item is in a store
+  template <typename T, typename Store> bool containsItem(const Store& store, node_id root, const T& delim, span<const T> word) noexcept {
+    node_id node_idx {findItem(store, root, delim, word)};
+    return node_idx != no_node && store.word(node_idx);
+  }
+  ///  Node completeItem ends at - a node of a completed post part or of a pre part, no completion - no_node
+  template <typename T, typename Store> node_id resolveItem(const Store& store, node_id root, const T& delim, span<const T> word) noexcept {
+    auto parts {divide(word, delim)};
+    if (parts.pre.empty()) {
+      return no_node;
+    }
+    auto pos {radix_dict::walkTree(store, root, parts.pre)};
+    if (!pos.found || pos.node == root) {
+      return no_node;
+    }
+    if (parts.post.empty()) {
+      return pos.node;
+    }
+    node_id postfix_root {store.postfix(pos.node)};
+    if (postfix_root == no_node) {
+      return no_node;
+    }
+    pos = radix_dict::walkTree(store, postfix_root, parts.post);
+    return pos.found && pos.node != postfix_root ? pos.node : no_node;
+  }
+
+  ///  Multi level item completion - every delimiter separated segment is completed in its level tree, a next
+  ///  level tree hangs off a segment end node. Item could end with a delimiter
+  template <typename T, typename Store> unique_ptr<vector<T>> completeLevels(const Store& store, node_id root, const T& delim, span<const T> word) {
+    auto ret {make_unique<vector<T>>()};
+    node_id level_root {root};
+    for (auto seg_start {word.begin()};;) {
+      auto seg_end {std::find(seg_start, word.end(), delim)};
+      span<const T> segment {seg_start, seg_end};
+      if (segment.empty()) {
+        //  Only a trailing delimiter after a complete segment is valid
+        if (seg_start != word.end() || level_root == root) {
+          ret.reset();
+        }
+        break;
+      }
+      node_id node_idx {radix_dict::completeWord(store, level_root, segment, *ret)};
+      if (node_idx == no_node) {
+        ret.reset();
+        break;
+      }
+      if (seg_end == word.end()) {
+        break;
+      }
+      ret->push_back(delim);
+      level_root = store.postfix(node_idx);
+      if (level_root == no_node) {
+        //  A segment is a last one in this item, a trailing delimiter is still fine
+        if (seg_end + 1 != word.end()) {
+          ret.reset();
+        }
+        break;
+      }
+      seg_start = seg_end + 1;
+    }
+    return ret;
+  }
+  ///  Check if exactly this multi level item is in a store
+  template <typename T, typename Store> bool containsLevels(const Store& store, node_id root, const T& delim, span<const T> word) noexcept {
+    node_id level_root {root};
+    for (auto seg_start {word.begin()};;) {
+      auto seg_end {std::find(seg_start, word.end(), delim)};
+      if (seg_start == seg_end) {
+        return false;
+      }
+      node_id node_idx {radix_dict::findWord(store, level_root, span<const T>{seg_start, seg_end})};
+      if (node_idx == no_node) {
+        return false;
+      }
+      if (seg_end == word.end()) {
+        return store.word(node_idx);
+      }
+      level_root = store.postfix(node_idx);
+      if (level_root == no_node) {
+        return false;
+      }
+      seg_start = seg_end + 1;
+    }
+  }
+
+  ///  Container to store command dived by any kind of delimiters
+  template <typename T, typename Alloc = std::allocator<T>, radix_dict::LetterTraitsOf<T> Traits = radix_dict::LetterTraits<T>>
+  class Dict : public Node<T, Alloc, Traits> {
+    protected :
+      T delim;
+
+      //  Add sorted items to an empty dictionary in one pass. Pre parts go through one sorted path, post parts
+      //  of the same pre part through a sorted path of its postfix tree
+      template <typename R> void buildSorted(R&& words) {
+        typename Node<T, Alloc, Traits>::SortedPath pre_path {*this, this->root_branches};
+        std::optional<typename Node<T, Alloc, Traits>::SortedPath> post_path;
+        node_id pre_node {no_node};
+        auto word_it {ranges::begin(words)};
+        for (; word_it != ranges::end(words); ++word_it) {
+          auto&& word {*word_it};
+          auto parts {divide(radix_dict::wordSpan<T>(word), delim)};
+          if (parts.pre.empty()) {
+            continue;
+          }
+          node_id node_idx {pre_path.add(parts.pre)};
+          if (node_idx == no_node) {
+            break;
+          }
+          if (node_idx != pre_node) {
+            pre_node = node_idx;
+            post_path.reset();
+          }
+          if (!parts.post.empty()) {
+            if (!post_path) {
+              node_id postfix_root {this->arena.make({})};
+              this->arena[pre_node].postfix_tree = postfix_root;
+              post_path.emplace(*this, postfix_root);
+            }
+            node_idx = post_path->add(parts.post);
+            if (node_idx == no_node) {
+              break;
+            }
+          }
+          this->arena[node_idx].word = true;
+        }
+        this->recountItems();
+        for (; word_it != ranges::end(words); ++word_it) {
+          ins(*word_it);
+        }
+      }
+      //  Add an item, returns a node where the new item ends or no_node for an item without a pre part or
+      //  an item in the dictionary already
+      node_id insItem(span<const T> letters) {
+        auto parts {divide(letters, delim)};
+
+        //  Check data
+        if (parts.pre.empty()) {
+          return no_node;
+        }
+        this->unshare();
+
+        //  Pre part goes to the main tree, post part - to a postfix tree of the pre part node
+        node_id node_idx {this->insTree(this->root_branches, parts.pre)};
+        node_id postfix_root {no_node};
+        if (!parts.post.empty()) {
+          postfix_root = this->arena[node_idx].postfix_tree;
+          if (postfix_root == no_node) {
+            postfix_root = this->arena.make({});
+            this->arena[node_idx].postfix_tree = postfix_root;
+          }
+          node_idx = this->insTree(postfix_root, parts.post);
+        }
+        Leaf<T>& node {this->arena[node_idx]};
+        if (node.word) {
+          return no_node;
+        }
+        node.word = true;
+        this->countPath(this->root_branches, parts.pre);
+        if (postfix_root != no_node) {
+          this->countPath(postfix_root, parts.post);
+        }
+        return node_idx;
+      }
+      //  Node of a prefix and prefix letters before the node label, no_node if no item starts with the prefix
+      pair<node_id, size_t> prefixNode(span<const T> letters) const noexcept {
+        auto parts {divide(letters, delim)};
+        node_id root {this->root_branches};
+        size_t head_len {0};
+
+        //  Prefix with a delimiter - pre part is complete, post part is a prefix in the postfix tree
+        if (parts.postfix) {
+          node_id node_idx {parts.pre.empty() ? no_node : this->findWord(root, parts.pre)};
+          root = node_idx == no_node ? no_node : this->arena[node_idx].postfix_tree;
+          if (root == no_node) {
+            return {no_node, 0};
+          }
+          head_len = parts.pre.size() + 1;
+        }
+        auto pos {this->goTree(root, parts.postfix ? parts.post : parts.pre)};
+        if (!pos.found) {
+          return {no_node, 0};
+        }
+        return {pos.node, head_len + pos.depth};
+      }
+    public :
+      ///  Creating an empty dictionary container with a delimetr
+      explicit Dict (const T delim) : Node<T, Alloc, Traits>(), delim{delim} {};
+      ///  Creating an empty dictionary, all its memory is taken from an allocator
+      Dict (const T delim, const Alloc& alloc) : Node<T, Alloc, Traits>(alloc), delim{delim} {};
+      ///  Creating a dictionary container with a delimetr by a list of items
+      Dict (const T delim, std::initializer_list<vector<T>> init_lst) : Dict (delim) {
+        for (auto comm : init_lst) {
+          ins (std::move(comm));
+        }
+      }
+      ///  Creating a dictionary container from items sorted by pre part and then by post part in one pass, parts are
+      ///  compared as strings (keyLess). Items out of order are still inserted but one by one
+      template <ranges::input_range R> requires radix_dict::WordOf<ranges::range_value_t<R>, T>
+      [[nodiscard]] static Dict build_sorted(const T delim, R&& words) {
+        Dict dict {delim};
+        dict.buildSorted(words);
+        return dict;
+      }
+      ///  Insert a new item to container
+      bool ins(vector<T> &&letters) noexcept {return ins(span<const T>{letters});}
+      ///  Insert a new item given as a span, string or string view
+      template <radix_dict::WordOf<T> W> bool ins(const W& word) noexcept {return this->countInsert(insItem(radix_dict::wordSpan<T>(word)) != no_node);}
+      ///  Move all items of another dictionary to the dictionary, see RadixTree::merge. Dictionaries with different
+      ///  delimiters are not merged - returns 0 and the other one stays as is
+      template <std::same_as<Dict> Other> size_t merge(Other&& other) {return other.delim == delim ? this->mergeTree(other) : 0;}
+      ///  Insert many items by up to thread_count threads, parts of items with different leading letters of pre
+      ///  parts are built in parallel and joined, see RadixTree::bulk_insert. Returns a number of inserted items
+      template <ranges::forward_range R> requires radix_dict::WordOf<ranges::range_value_t<R>, T> && std::is_lvalue_reference_v<ranges::range_reference_t<R>>
+      size_t bulk_insert(R&& words, size_t thread_count = std::thread::hardware_concurrency()) {
+        vector<span<const T>> letters;
+        for (const auto& word : words) {
+          letters.push_back(radix_dict::wordSpan<T>(word));
+        }
+        if (this->bulkSerial(letters.size(), thread_count)) {
+          return static_cast<size_t>(ranges::count_if(letters, [this](span<const T> word){return ins(word);}));
+        }
+        return this->template bulkInsert<Dict>(std::move(letters), thread_count, [this]{return Dict(delim, this->arena.get_allocator());},
+                                               [](Dict& sub, span<const T> word){return sub.insItem(word);},
+                                               [this](span<const T> word){return insItem(word);},
+                                               [this](span<const T> word){return static_cast<size_t>(ranges::find(word, delim) - word.begin());});
+      }
+      ///  Get an item from container
+      [[nodiscard]] unique_ptr<vector<T>> get(vector<T> const &&word) const noexcept {return get(span<const T>{word});}
+      ///  Get an item by a span, string or string view, the tree is walked without any copy of the word
+      template <radix_dict::WordOf<T> W> [[nodiscard]] unique_ptr<vector<T>> get(const W& word) const noexcept {
+        auto ret {completeItem(this->arena, this->root_branches, delim, radix_dict::wordSpan<T>(word))};
+        this->countLookup(ret != nullptr);
+        return ret;
+      }
+      ///  Get an item as spans over the item and node labels, nothing is allocated. See WordView
+      template <radix_dict::WordOf<T> W> [[nodiscard]] std::optional<radix_dict::WordView<T>> get_view(const W& word) const noexcept {
+        auto view {viewItem(this->arena, this->root_branches, delim, radix_dict::wordSpan<T>(word))};
+        this->countLookup(view.has_value());
+        return view;
+      }
+      template <radix_dict::WordOf<T> W> requires (!ranges::borrowed_range<W> && !std::is_pointer_v<W>) void get_view(const W&& word) const = delete; //  A view would refer to a temporary item
+      ///  Write an item to an output iterator, nothing is allocated writing to a buffer of enough size. Returns an
+      ///  iterator past the item, nothing is written for a missing item
+      template <radix_dict::WordOf<T> W, std::output_iterator<const T&> Out> std::optional<Out> get_to(const W& word, Out out) const {
+        auto view {get_view(word)};
+        if (!view) {
+          return std::nullopt;
+        }
+        return view->copy(std::move(out));
+      }
+      ///  Check if exactly this item was inserted to container
+      template <radix_dict::WordOf<T> W> [[nodiscard]] bool contains(const W& word) const noexcept {
+        return this->countLookup(containsItem(this->arena, this->root_branches, delim, radix_dict::wordSpan<T>(word)));
+      }
+      ///  Items within max_distance edits of a whole item (delimiter included), nearest first, up to limit ones
+      template <radix_dict::WordOf<T> W> [[nodiscard]] vector<radix_dict::FuzzyMatch<T>> fuzzy_get(const W& word, size_t max_distance, size_t limit = std::numeric_limits<size_t>::max()) const {
+        auto found {radix_dict::fuzzyFind(this->arena, this->root_branches, radix_dict::wordSpan<T>(word), max_distance, std::optional<T>{delim})};
+        found.resize(std::min(found.size(), limit));
+        return found;
+      }
+      ///  Erase an item, a postfix tree left empty is released with its pre part node if the node is not needed
+      template <radix_dict::WordOf<T> W> bool erase(const W& word) noexcept {
+        auto parts {divide(radix_dict::wordSpan<T>(word), delim)};
+        if (parts.pre.empty()) {
+          return false;
+        }
+        this->unshare();
+        auto erase_word = [this](node_id node_idx){return this->eraseWord(node_idx);};
+        if (parts.post.empty()) {
+          return this->eraseTree(this->root_branches, parts.pre, erase_word);
+        }
+        return this->eraseTree(this->root_branches, parts.pre, [&](node_id node_idx){
+          return this->erasePostfix(node_idx, [&](node_id postfix_root){return this->eraseTree(postfix_root, parts.post, erase_word);});
+        });
+      }
+      ///  Get many items at once, lookups are interleaved to hide memory latency. Pre parts are walked
+      ///  together first, then post parts in their postfix trees. Returns number of found items
+      template <radix_dict::WordOf<T> W> size_t get_batch(span<const W> words, span<unique_ptr<vector<T>>> results) const noexcept {
+        size_t count {std::min(words.size(), results.size())};
+        vector<Parts<T>> parts;
+        vector<radix_dict::BatchWalk<T>> walks;
+        parts.reserve(count);
+        walks.reserve(count);
+        for (size_t pos = 0; pos < count; ++pos) {
+          parts.push_back(divide(radix_dict::wordSpan<T>(words[pos]), delim));
+          walks.push_back({this->root_branches, parts.back().pre});
+        }
+        radix_dict::walkTrees(this->arena, span<radix_dict::BatchWalk<T>>{walks});
+
+        //  Pre part completions, walks of post parts are put in place of pre part ones
+        vector<radix_dict::BatchWalk<T>> post_walks;
+        vector<size_t> post_items;
+        for (size_t pos = 0; pos < count; ++pos) {
+          results[pos] = make_unique<vector<T>>();
+          node_id node_idx {parts[pos].pre.empty() ? no_node : radix_dict::completePos(this->arena, this->root_branches, parts[pos].pre, walks[pos].pos, *results[pos])};
+          if (node_idx == no_node) {
+            results[pos].reset();
+          } else if (parts[pos].postfix) {
+            results[pos]->push_back(delim);
+            if (!parts[pos].post.empty()) {
+              node_id postfix_root {this->arena.postfix(node_idx)};
+              if (postfix_root == no_node) {
+                results[pos].reset();
+              } else {
+                post_walks.push_back({postfix_root, parts[pos].post});
+                post_items.push_back(pos);
+              }
+            }
+          }
+        }
+        radix_dict::walkTrees(this->arena, span<radix_dict::BatchWalk<T>>{post_walks});
+        for (size_t walk = 0; walk < post_walks.size(); ++walk) {
+          const auto& post_walk {post_walks[walk]};
+          if (radix_dict::completePos(this->arena, post_walk.root, post_walk.word, post_walk.pos, *results[post_items[walk]]) == no_node) {
+            results[post_items[walk]].reset();
+          }
+        }
+        return static_cast<size_t>(ranges::count_if(results.first(count), [](const auto& ret){return ret != nullptr;}));
+      }
+      ///  Lazy range of up to limit items starting with a prefix, in order of keys
+      template <radix_dict::WordOf<T> W>
+      [[nodiscard]] radix_dict::Completions<T, radix_dict::NodeArena<T, Alloc, Traits>> completions(const W& prefix, size_t limit = std::numeric_limits<size_t>::max()) const {
+        auto letters {radix_dict::wordSpan<T>(prefix)};
+        auto [node_idx, head_len] {prefixNode(letters)};
+        if (node_idx == no_node) {
+          return {};
+        }
+        return {this->arena, node_idx, letters.first(head_len), limit, delim};
+      }
+      ///  Number of items starting with a prefix, O(prefix length)
+      template <radix_dict::WordOf<T> W> [[nodiscard]] size_t count_prefix(const W& prefix) const noexcept {
+        node_id node_idx {prefixNode(radix_dict::wordSpan<T>(prefix)).first};
+        return node_idx == no_node ? 0 : this->arena[node_idx].items;
+      }
+      ///  Exactly one item starts with a prefix
+      template <radix_dict::WordOf<T> W> [[nodiscard]] bool is_unique(const W& prefix) const noexcept {return count_prefix(prefix) == 1;}
+      ///  k-th (from 0) item starting with a prefix, the same as k-th one of completions
+      template <radix_dict::WordOf<T> W> [[nodiscard]] unique_ptr<vector<T>> kth(const W& prefix, size_t k) const {
+        auto letters {radix_dict::wordSpan<T>(prefix)};
+        auto [node_idx, head_len] {prefixNode(letters)};
+        unique_ptr<vector<T>> ret;
+        if (node_idx != no_node) {
+          ret = make_unique<vector<T>>(letters.begin(), letters.begin() + head_len);
+          if (!this->kthItem(node_idx, k, *ret, delim)) {
+            ret.reset();
+          }
+        }
+        return ret;
+      }
+      ///  Number of items ordered before an item (its position in completions of all items), the item could be absent
+      template <radix_dict::WordOf<T> W> [[nodiscard]] size_t rank(const W& word) const noexcept {
+        auto letters {radix_dict::wordSpan<T>(word)};
+        auto parts {divide(letters, delim)};
+        return this->rankItem(this->root_branches, parts.post.empty() ? parts.pre : letters, delim, 1);
+      }
+      ///  Cursor for an item typed letter by letter, the first delimiter moves it to a postfix tree
+      [[nodiscard]] radix_dict::Cursor<T, radix_dict::NodeArena<T, Alloc, Traits>> cursor() const noexcept {
+        return {this->arena, this->root_branches, delim, 1};
+      }
+      ///  Compile container to a read only image, see FrozenDict
+      [[nodiscard]] vector<std::byte> freeze() const requires radix_dict::plain_traits<Traits, T> {return this->freezeTree(radix_dict::image_dict, delim);}
+      ///  Compile container and write the image to a file
+      bool save(const std::filesystem::path& path) const requires radix_dict::plain_traits<Traits, T> {return radix_dict::saveImage(path, freeze());}
+  };
+
+  ///  Dictionary with a payload (a command handler) for every item. An abbreviated item is resolved and its
+  ///  payload is found in one descent, no completion is made
+  template <typename T, typename V, typename Alloc = std::allocator<T>> class DictMap : public Dict<T, Alloc> {
+    private :
+      radix_dict::ValuePool<V, Alloc> values;
+
+      //  Payload of an item node, nullptr for a node not ending an item
+      const V* nodeValue(node_id node_idx) const noexcept {
+        const Leaf<T>& node {this->arena[node_idx]};
+        return node.word ? &*values.slots[node.value] : nullptr;
+      }
+    public :
+      ///  Creating an empty map with a delimiter
+      explicit DictMap (const T delim) : Dict<T, Alloc>(delim), values{Alloc()} {}
+      ///  Creating an empty map, all its memory is taken from an allocator
+      DictMap (const T delim, const Alloc& alloc) : Dict<T, Alloc>(delim, alloc), values{alloc} {}
+      ///  Creating a map with a delimiter by a list of items and payloads
+      DictMap (const T delim, std::initializer_list<pair<vector<T>, V>> init) : DictMap(delim) {
+        for (const auto& [item, value] : init) {
+          ins(item, value);
+        }
+      }
+      ///  Payloads are not moved by merge of dictionaries
+      template <typename Other> size_t merge(Other&& other) = delete;
+      ///  Words of bulk_insert would have no payloads
+      template <typename R> size_t bulk_insert(R&& words, size_t thread_count = 0) = delete;
+      ///  Words of different payloads are not the same
+      size_t minimize() = delete;
+      ///  Insert a new item with a payload, a payload of an item in the map already is not changed
+      template <radix_dict::WordOf<T> W> bool ins(const W& word, V value) {
+        node_id node_idx {this->insItem(radix_dict::wordSpan<T>(word))};
+        if (node_idx == no_node) {
+          return this->countInsert(false);
+        }
+        this->arena[node_idx].value = values.make(std::move(value));
+        return this->countInsert(true);
+      }
+      ///  Payload of an item an abbreviation is completed to (the same one get gives), nullptr if the completion
+      ///  is not an item. A single descent of pre and post parts - no completion is made
+      template <radix_dict::WordOf<T> W> [[nodiscard]] V* find(const W& abbrev) noexcept {return const_cast<V*>(std::as_const(*this).find(abbrev));}
+      template <radix_dict::WordOf<T> W> [[nodiscard]] const V* find(const W& abbrev) const noexcept {
+        node_id node_idx {resolveItem(this->arena, this->root_branches, this->delim, radix_dict::wordSpan<T>(abbrev))};
+        const V* value {node_idx == no_node ? nullptr : nodeValue(node_idx)};
+        this->countLookup(value != nullptr);
+        return value;
+      }
+      ///  Payload of exactly this item, nullptr if the item is not in the map
+      template <radix_dict::WordOf<T> W> [[nodiscard]] V* find_exact(const W& word) noexcept {return const_cast<V*>(std::as_const(*this).find_exact(word));}
+      template <radix_dict::WordOf<T> W> [[nodiscard]] const V* find_exact(const W& word) const noexcept {
+        node_id node_idx {findItem(this->arena, this->root_branches, this->delim, radix_dict::wordSpan<T>(word))};
+        const V* value {node_idx == no_node ? nullptr : nodeValue(node_idx)};
+        this->countLookup(value != nullptr);
+        return value;
+      }
+      ///  Erase an item with its payload
+      template <radix_dict::WordOf<T> W> bool erase(const W& word) noexcept {
+        node_id node_idx {findItem(this->arena, this->root_branches, this->delim, radix_dict::wordSpan<T>(word))};
+        if (node_idx == no_node || !this->arena[node_idx].word) {
+          return false;
+        }
+        values.release(std::exchange(this->arena[node_idx].value, no_node));
+        return Dict<T, Alloc>::erase(word);
+      }
+      ///  Remove all items and payloads
+      void clear() noexcept {
+        Dict<T, Alloc>::clear();
+        values.clear();
+      }
+  };
+
+  ///  Container to store commands of any number of delimiter separated segments (tool sub action --flag).
+  ///  Every level has its own tree hanging off a segment end node, so an abbreviated item (t s a) is completed
+  ///  segment by segment (tool sub action) in one pass over the item
+  template <typename T, typename Alloc = std::allocator<T>> class HierDict : public Node<T, Alloc> {
+    private :
+      T delim;
+
+      //  Erase a rest of an item from a level tree, segment by segment
+      bool eraseLevel(node_id level_root, span<const T> word) {
+        auto seg_end {ranges::find(word, delim)};
+        span<const T> segment {word.begin(), seg_end};
+        if (seg_end == word.end()) {
+          return this->eraseTree(level_root, segment, [this](node_id node_idx){return this->eraseWord(node_idx);});
+        }
+        auto rest {word.subspan(segment.size() + 1)};
+        return !segment.empty() && !rest.empty() && this->eraseTree(level_root, segment, [&](node_id node_idx){
+          return this->erasePostfix(node_idx, [&](node_id next_root){return eraseLevel(next_root, rest);});
+        });
+      }
+      //  Insert an item level by level, returns a node where the item ends or no_node for an item with an empty
+      //  segment or an item inserted already
+      node_id insLevels(span<const T> letters) {
+        //  Check data
+        if (letters.empty() || letters.front() == delim || letters.back() == delim ||
+            ranges::adjacent_find(letters, [this](const T& left, const T& right){return left == delim && right == delim;}) != letters.end()) {
+          return no_node;
+        }
+        this->unshare();
+
+        node_id node_idx {this->root_branches};
+        for (auto seg_start {letters.begin()};;) {
+          auto seg_end {std::find(seg_start, letters.end(), delim)};
+          if (node_idx != this->root_branches) {
+            //  Next segment goes to a level tree of a previous segment node
+            if (this->arena[node_idx].postfix_tree == no_node) {
+              node_id level_root {this->arena.make({})};
+              this->arena[node_idx].postfix_tree = level_root;
+            }
+            node_idx = this->arena[node_idx].postfix_tree;
+          }
+          node_idx = this->insTree(node_idx, span<const T>{seg_start, seg_end});
+          if (seg_end == letters.end()) {
+            break;
+          }
+          seg_start = seg_end + 1;
+        }
+        Leaf<T>& node {this->arena[node_idx]};
+        if (node.word) {
+          return no_node;
+        }
+        node.word = true;
+        const node_id item_end {node_idx};
+
+        //  The item is counted in every level it goes through
+        node_id level_root {this->root_branches};
+        for (auto seg_start {letters.begin()};;) {
+          auto seg_end {std::find(seg_start, letters.end(), delim)};
+          node_idx = this->countPath(level_root, span<const T>{seg_start, seg_end});
+          if (seg_end == letters.end()) {
+            break;
+          }
+          level_root = this->arena[node_idx].postfix_tree;
+          seg_start = seg_end + 1;
+        }
+        return item_end;
+      }
+      //  Node of a prefix and prefix letters before the node label, no_node if no item starts with the prefix.
+      //  Segments before the last delimiter should be complete
+      pair<node_id, size_t> prefixNode(span<const T> letters) const noexcept {
+        node_id level_root {this->root_branches};
+        auto seg_start {letters.begin()};
+        for (auto seg_end {std::find(seg_start, letters.end(), delim)}; seg_end != letters.end(); seg_end = std::find(seg_start, letters.end(), delim)) {
+          node_id node_idx {seg_start == seg_end ? no_node : this->findWord(level_root, span<const T>{seg_start, seg_end})};
+          level_root = node_idx == no_node ? no_node : this->arena[node_idx].postfix_tree;
+          if (level_root == no_node) {
+            return {no_node, 0};
+          }
+          seg_start = seg_end + 1;
+        }
+        auto pos {this->goTree(level_root, span<const T>{seg_start, letters.end()})};
+        if (!pos.found) {
+          return {no_node, 0};
+        }
+        return {pos.node, static_cast<size_t>(seg_start - letters.begin()) + pos.depth};
+      }
+    public :
+      ///  Creating an empty dictionary container with a delimetr
+      explicit HierDict (const T delim) : Node<T, Alloc>(), delim{delim} {};
+      ///  Creating an empty dictionary, all its memory is taken from an allocator
+      HierDict (const T delim, const Alloc& alloc) : Node<T, Alloc>(alloc), delim{delim} {};
+      ///  Creating a dictionary container with a delimetr by a list of items
+      HierDict (const T delim, std::initializer_list<vector<T>> init_lst) : HierDict (delim) {
+        for (const auto& comm : init_lst) {
+          ins (comm);
+        }
+      }
+      ///  Insert a new item, every segment should be non empty
+      template <radix_dict::WordOf<T> W> bool ins(const W& word) noexcept {return this->countInsert(insLevels(radix_dict::wordSpan<T>(word)) != no_node);}
+      ///  Insert many items by up to thread_count threads, parts of items with different leading letters of first
+      ///  segments are built in parallel with all their levels and joined, see RadixTree::bulk_insert. Returns
+      ///  a number of inserted items
+      template <ranges::forward_range R> requires radix_dict::WordOf<ranges::range_value_t<R>, T> && std::is_lvalue_reference_v<ranges::range_reference_t<R>>
+      size_t bulk_insert(R&& words, size_t thread_count = std::thread::hardware_concurrency()) {
+        vector<span<const T>> letters;
+        for (const auto& word : words) {
+          letters.push_back(radix_dict::wordSpan<T>(word));
+        }
+        if (this->bulkSerial(letters.size(), thread_count)) {
+          return static_cast<size_t>(ranges::count_if(letters, [this](span<const T> word){return ins(word);}));
+        }
+        return this->template bulkInsert<HierDict>(std::move(letters), thread_count, [this]{return HierDict(delim, this->arena.get_allocator());},
+                                                   [](HierDict& sub, span<const T> word){return sub.insLevels(word);},
+                                                   [this](span<const T> word){return insLevels(word);},
+                                                   [this](span<const T> word){return static_cast<size_t>(ranges::find(word, delim) - word.begin());});
+      }
+      ///  Get an item, every segment is completed in its level
+      template <radix_dict::WordOf<T> W> [[nodiscard]] unique_ptr<vector<T>> get(const W& word) const noexcept {
+        auto ret {completeLevels(this->arena, this->root_branches, delim, radix_dict::wordSpan<T>(word))};
+        this->countLookup(ret != nullptr);
+        return ret;
+      }
+      ///  Check if exactly this item was inserted to container
+      template <radix_dict::WordOf<T> W> [[nodiscard]] bool contains(const W& word) const noexcept {
+        return this->countLookup(containsLevels(this->arena, this->root_branches, delim, radix_dict::wordSpan<T>(word)));
+      }
+      ///  Cursor for an item typed letter by letter, every delimiter moves it to a next level tree
+      [[nodiscard]] radix_dict::Cursor<T, radix_dict::NodeArena<T, Alloc>> cursor() const noexcept {
+        return {this->arena, this->root_branches, delim, std::numeric_limits<std::uint32_t>::max()};
+      }
+      ///  Number of items starting with a prefix of whole segments and a last segment start, O(prefix length)
+      template <radix_dict::WordOf<T> W> [[nodiscard]] size_t count_prefix(const W& prefix) const noexcept {
+        node_id node_idx {prefixNode(radix_dict::wordSpan<T>(prefix)).first};
+        return node_idx == no_node ? 0 : this->arena[node_idx].items;
+      }
+      ///  Exactly one item starts with a prefix
+      template <radix_dict::WordOf<T> W> [[nodiscard]] bool is_unique(const W& prefix) const noexcept {return count_prefix(prefix) == 1;}
+      ///  k-th (from 0) item starting with a prefix in order of keys, a level tree goes at a place of the delimiter
+      template <radix_dict::WordOf<T> W> [[nodiscard]] unique_ptr<vector<T>> kth(const W& prefix, size_t k) const {
+        auto letters {radix_dict::wordSpan<T>(prefix)};
+        auto [node_idx, head_len] {prefixNode(letters)};
+        unique_ptr<vector<T>> ret;
+        if (node_idx != no_node) {
+          ret = make_unique<vector<T>>(letters.begin(), letters.begin() + head_len);
+          if (!this->kthItem(node_idx, k, *ret, delim)) {
+            ret.reset();
+          }
+        }
+        return ret;
+      }
+      ///  Number of items ordered before an item (kth order), the item could be absent
+      template <radix_dict::WordOf<T> W> [[nodiscard]] size_t rank(const W& word) const noexcept {
+        return this->rankItem(this->root_branches, radix_dict::wordSpan<T>(word), delim, std::numeric_limits<std::uint32_t>::max());
+      }
+      ///  Erase an item, level trees left empty are released
+      template <radix_dict::WordOf<T> W> bool erase(const W& word) noexcept {
+        auto letters {radix_dict::wordSpan<T>(word)};
+        this->unshare();
+        return !letters.empty() && eraseLevel(this->root_branches, letters);
+      }
+      ///  Move all items of another dictionary to the dictionary, level trees are joined level by level, see
+      ///  RadixTree::merge. Dictionaries with different delimiters are not merged - returns 0 and the other one stays as is
+      template <std::same_as<HierDict> Other> size_t merge(Other&& other) {return other.delim == delim ? this->mergeTree(other) : 0;}
+      ///  Items are split to levels by ins, a tree built from flat sorted words would have no levels
+      template <typename R> static HierDict build_sorted(R&& words) = delete;
+      ///  Items of many levels are not a fixed set of spans, see get
+      template <typename W> void get_view(const W& word) const = delete;
+      template <typename W, typename Out> void get_to(const W& word, Out out) const = delete;
+      ///  Get many items at once, lookups are interleaved to hide memory latency. Segments of a level are walked
+      ///  together, then next segments in their level trees. Returns number of found items
+      template <radix_dict::WordOf<T> W> size_t get_batch(span<const W> words, span<unique_ptr<vector<T>>> results) const noexcept {
+        struct Level {
+          size_t item;
+          node_id root;
+          span<const T> rest; //  Item letters from a segment of the level
+        };
+        size_t count {std::min(words.size(), results.size())};
+        vector<Level> levels, walked;
+        vector<radix_dict::BatchWalk<T>> walks;
+        for (size_t pos = 0; pos < count; ++pos) {
+          results[pos] = make_unique<vector<T>>();
+          levels.push_back({pos, this->root_branches, radix_dict::wordSpan<T>(words[pos])});
+        }
+        while (!levels.empty()) {
+          walked.clear();
+          walks.clear();
+          for (const auto& level : levels) {
+            span<const T> segment {level.rest.begin(), ranges::find(level.rest, delim)};
+            if (!segment.empty()) {
+              walked.push_back(level);
+              walks.push_back({level.root, segment});
+            } else if (!level.rest.empty() || level.root == this->root_branches) {
+              //  Only a trailing delimiter after a complete segment is valid
+              results[level.item].reset();
+            }
+          }
+          radix_dict::walkTrees(this->arena, span<radix_dict::BatchWalk<T>>{walks});
+
+          levels.clear();
+          for (size_t walk = 0; walk < walks.size(); ++walk) {
+            const auto& [item, level_root, rest] {walked[walk]};
+            node_id node_idx {radix_dict::completePos(this->arena, level_root, walks[walk].word, walks[walk].pos, *results[item])};
+            if (node_idx == no_node) {
+              results[item].reset();
+            } else if (walks[walk].word.size() != rest.size()) {
+              results[item]->push_back(delim);
+              node_id next_root {this->arena.postfix(node_idx)};
+              auto next_rest {rest.subspan(walks[walk].word.size() + 1)};
+              if (next_root != no_node) {
+                levels.push_back({item, next_root, next_rest});
+              } else if (!next_rest.empty()) {
+                results[item].reset();
+              }
+            }
+          }
+        }
+        return static_cast<size_t>(ranges::count_if(results.first(count), [](const auto& ret){return ret != nullptr;}));
+      }
+      ///  Lazy range of up to limit items starting with a prefix, in order of keys. Segments before the last
+      ///  delimiter of a prefix should be complete
+      template <radix_dict::WordOf<T> W>
+      [[nodiscard]] radix_dict::Completions<T, radix_dict::NodeArena<T, Alloc>> completions(const W& prefix, size_t limit = std::numeric_limits<size_t>::max()) const {
+        auto letters {radix_dict::wordSpan<T>(prefix)};
+        auto [node_idx, head_len] {prefixNode(letters)};
+        if (node_idx == no_node) {
+          return {};
+        }
+        return {this->arena, node_idx, letters.first(head_len), limit, delim};
+      }
+      ///  Items within max_distance edits of a whole item (delimiters included), nearest first, up to limit ones
+      template <radix_dict::WordOf<T> W> [[nodiscard]] vector<radix_dict::FuzzyMatch<T>> fuzzy_get(const W& word, size_t max_distance, size_t limit = std::numeric_limits<size_t>::max()) const {
+        auto found {radix_dict::fuzzyFind(this->arena, this->root_branches, radix_dict::wordSpan<T>(word), max_distance, std::optional<T>{delim})};
+        found.resize(std::min(found.size(), limit));
+        return found;
+      }
+      ///  Compile container to a read only image, see FrozenHierDict
+      [[nodiscard]] vector<std::byte> freeze() const {return this->freezeTree(radix_dict::image_levels, delim);}
+      ///  Compile container and write the image to a file
+      bool save(const std::filesystem::path& path) const {return radix_dict::saveImage(path, freeze());}
+  };
+
+  ///  Read only dictionary working straight on a compiled image (Dict::freeze), the image should outlive the dictionary
+  template <typename T> class FrozenDict : public radix_dict::FrozenTree<T> {
+    private :
+      T delim {};
+    public :
+      ///  Empty dictionary
+      FrozenDict () = default;
+      ///  Dictionary of a compiled Dict image
+      explicit FrozenDict (span<const std::byte> image) noexcept : radix_dict::FrozenTree<T>(image, radix_dict::image_dict) {
+        if (this->valid()) {
+          std::memcpy(&delim, &this->view.head()->delim, sizeof(T));
+        }
+      }
+      ///  Get an item from container
+      template <radix_dict::WordOf<T> W> [[nodiscard]] unique_ptr<vector<T>> get(const W& word) const noexcept {
+        if (!this->valid()) {
+          return {};
+        }
+        return completeItem(this->view, this->view.head()->root, delim, radix_dict::wordSpan<T>(word));
+      }
+      ///  Check if exactly this item is in container
+      template <radix_dict::WordOf<T> W> [[nodiscard]] bool contains(const W& word) const noexcept {
+        return this->valid() && containsItem(this->view, this->view.head()->root, delim, radix_dict::wordSpan<T>(word));
+      }
+  };
+
+  ///  Read only hierarchical dictionary working straight on a compiled image (HierDict::freeze), the image should
+  ///  outlive the dictionary
+  template <typename T> class FrozenHierDict : public radix_dict::FrozenTree<T> {
+    private :
+      T delim {};
+    public :
+      ///  Empty dictionary
+      FrozenHierDict () = default;
+      ///  Dictionary of a compiled HierDict image
+      explicit FrozenHierDict (span<const std::byte> image) noexcept : radix_dict::FrozenTree<T>(image, radix_dict::image_levels) {
+        if (this->valid()) {
+          std::memcpy(&delim, &this->view.head()->delim, sizeof(T));
+        }
+      }
+      ///  Get an item, every segment is completed in its level
+      template <radix_dict::WordOf<T> W> [[nodiscard]] unique_ptr<vector<T>> get(const W& word) const noexcept {
+        if (!this->valid()) {
+          return {};
+        }
+        return completeLevels(this->view, this->view.head()->root, delim, radix_dict::wordSpan<T>(word));
+      }
+      ///  Check if exactly this item is in container
+      template <radix_dict::WordOf<T> W> [[nodiscard]] bool contains(const W& word) const noexcept {
+        return this->valid() && containsLevels(this->view, this->view.head()->root, delim, radix_dict::wordSpan<T>(word));
+      }
+  };
+
+  ///  Dictionary kept on disk - a checkpoint image (Dict::save) and a journal of changes made after it. Opening loads
+  ///  the checkpoint and replays the journal, every insert, erase and clear appends a record to the journal.
+  ///  reload() applies records appended since the last load, so picking up a change costs O(change) and not
+  ///  O(dictionary). One process writes, any number of processes read and reload. checkpoint() saves a new image and
+  ///  starts an empty journal of a next generation, readers see the new generation and load the new image.
+  ///  Dict is a private base - a JournalDict is changed only by its journaled methods, queries are the ones of Dict
+  template <typename T, typename Alloc = std::allocator<T>> class JournalDict : private Dict<T, Alloc> {
+    private :
+      //  Journal file header, records follow - an operation, a number of letters and letters
+      struct JournalHeader {
+        char magic[8] {'C', 'L', 'I', 'J', 'R', 'N', 'L', '\0'};
+        std::uint32_t byte_order {0x01020304};
+        std::uint32_t letter_size {sizeof(T)};
+        std::uint64_t generation {0}; //  Number of a checkpoint the journal goes after
+      };
+      enum class Op : std::uint8_t {ins = 1, erase = 2, clear = 3};
+      static constexpr std::uint64_t record_head {sizeof(Op) + sizeof(std::uint32_t)};
+
+      std::filesystem::path image_path;
+      std::filesystem::path journal_path;
+      std::ofstream journal;
+      std::uint64_t generation {0};
+      std::uint64_t journal_pos {0}; //  Journal bytes applied to the tree, 0 before a first load
+      bool journal_ok {false};
+
+      //  Append a record and flush it to the system, not fsync'd - a record survives a crash of the process
+      //  but not a power loss
+      bool writeRecord(Op op, span<const T> letters) {
+        const std::uint32_t len {static_cast<std::uint32_t>(letters.size())};
+        journal.write(reinterpret_cast<const char*>(&op), sizeof(op));
+        journal.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        journal.write(reinterpret_cast<const char*>(letters.data()), static_cast<std::streamsize>(letters.size_bytes()));
+        journal_ok = journal.flush() && journal_ok;
+        journal_pos += record_head + letters.size_bytes();
+        return journal_ok;
+      }
+      //  Replace the journal by an empty one of a generation and open it for records
+      bool startJournal(std::uint64_t next_generation) {
+        auto tmp_path {journal_path};
+        tmp_path += ".tmp";
+        JournalHeader head {};
+        head.generation = next_generation;
+        {
+          std::ofstream file {tmp_path, std::ios::binary | std::ios::trunc};
+          if (!file.write(reinterpret_cast<const char*>(&head), sizeof(head)).flush()) {
+            return false;
+          }
+        }
+        std::error_code error;
+        std::filesystem::rename(tmp_path, journal_path, error);
+        journal = std::ofstream{journal_path, std::ios::binary | std::ios::app};
+        return !error && journal.is_open();
+      }
+      //  Header of an open journal, empty for a journal of other letters or byte order
+      static std::optional<JournalHeader> readHeader(std::ifstream& file) {
+        const JournalHeader reference {};
+        JournalHeader head {};
+        if (!file.read(reinterpret_cast<char*>(&head), sizeof(head)) || !std::equal(std::begin(head.magic), std::end(head.magic), std::begin(reference.magic)) ||
+            head.byte_order != reference.byte_order || head.letter_size != reference.letter_size) {
+          return std::nullopt;
+        }
+        return head;
+      }
+      //  Apply complete records of an open journal from journal_pos. A torn record at the end (a write in progress)
+      //  is left for a next reload, an unknown one stops the replay. Returns a number of applied records
+      size_t replay(std::ifstream& file) {
+        file.seekg(0, std::ios::end);
+        const std::uint64_t size {static_cast<std::uint64_t>(file.tellg())};
+        file.seekg(static_cast<std::streamoff>(journal_pos));
+        size_t applied {0};
+        vector<T> letters;
+        while (journal_pos + record_head <= size) {
+          Op op {};
+          std::uint32_t len {0};
+          file.read(reinterpret_cast<char*>(&op), sizeof(op));
+          file.read(reinterpret_cast<char*>(&len), sizeof(len));
+          if (!file || journal_pos + record_head + std::uint64_t{len} * sizeof(T) > size) {
+            break;
+          }
+          letters.resize(len);
+          if (!file.read(reinterpret_cast<char*>(letters.data()), static_cast<std::streamsize>(len * sizeof(T)))) {
+            break;
+          }
+          switch (op) {
+            case Op::ins :
+              Dict<T, Alloc>::ins(letters);
+              break;
+            case Op::erase :
+              Dict<T, Alloc>::erase(letters);
+              break;
+            case Op::clear :
+              Dict<T, Alloc>::clear();
+              break;
+            default :
+              return applied;
+          }
+          journal_pos += record_head + std::uint64_t{len} * sizeof(T);
+          ++applied;
+        }
+        return applied;
+      }
+      //  Load a checkpoint image and replay a whole journal, a missing image is an empty dictionary. A new image
+      //  with an old journal (a checkpoint broken between renames) gives the same items - every record sets
+      //  the state of its item the checkpoint has already
+      size_t loadAll(std::ifstream& file, std::uint64_t file_generation) {
+        Dict<T, Alloc>::clear();
+        generation = file_generation;
+        journal_pos = sizeof(JournalHeader);
+        journal_ok = true;
+        if (std::ifstream image_file {image_path, std::ios::binary | std::ios::ate}) {
+          vector<std::byte> image(static_cast<size_t>(image_file.tellg()));
+          image_file.seekg(0);
+          image_file.read(reinterpret_cast<char*>(image.data()), static_cast<std::streamsize>(image.size()));
+          radix_dict::ImageView<T> view {image};
+          T image_delim {};
+          if (view.validate()) {
+            std::memcpy(&image_delim, &view.head()->delim, sizeof(T));
+          }
+          journal_ok = image_file && view.head() && view.head()->flags == radix_dict::image_dict && image_delim == this->delim;
+          if (journal_ok) {
+            this->buildSorted(radix_dict::Completions<T, radix_dict::ImageView<T>>{view, view.head()->root, {}, std::numeric_limits<size_t>::max(), this->delim});
+          }
+        }
+        journal = std::ofstream{journal_path, std::ios::binary | std::ios::app};
+        journal_ok = journal_ok && journal.is_open();
+        return replay(file);
+      }
+    public :
+      ///  Open a dictionary of an image file and a journal file - the image path with .journal added, a missing
+      ///  journal is created. See valid() for a result
+      JournalDict (const T delim, std::filesystem::path path, const Alloc& alloc = Alloc()) :
+        Dict<T, Alloc>(delim, alloc), image_path{std::move(path)}, journal_path{image_path} {
+        journal_path += ".journal";
+        std::error_code error;
+        if (!std::filesystem::exists(journal_path, error) && !startJournal(0)) {
+          return;
+        }
+        reload();
+      }
+      ///  Journal and checkpoint are read and every change is written to the journal
+      [[nodiscard]] bool valid() const noexcept {return journal_ok;}
+      ///  Apply journal records written after the last load or reload, the whole dictionary is loaded again after
+      ///  a checkpoint. Returns a number of applied records
+      size_t reload() {
+        std::ifstream file {journal_path, std::ios::binary};
+        auto head {readHeader(file)};
+        if (!head) {
+          journal_ok = false;
+          return 0;
+        }
+        return journal_pos == 0 || head->generation != generation ? loadAll(file, head->generation) : replay(file);
+      }
+      ///  Save the dictionary as a new checkpoint image and start an empty journal, both files are replaced by renames.
+      ///  Files and renames are flushed but not fsync'd, a checkpoint survives a crash of the process but not a power loss
+      bool checkpoint() {
+        auto tmp_path {image_path};
+        tmp_path += ".tmp";
+        std::error_code error;
+        if (!this->save(tmp_path) || (std::filesystem::rename(tmp_path, image_path, error), error) || !startJournal(generation + 1)) {
+          return journal_ok = false;
+        }
+        ++generation;
+        journal_pos = sizeof(JournalHeader);
+        return journal_ok = true;
+      }
+      ///  Insert a new item and write it to the journal. False if the item is in the dictionary already or the record
+      ///  is not written (valid() is false then)
+      template <radix_dict::WordOf<T> W> bool ins(const W& word) {
+        auto letters {radix_dict::wordSpan<T>(word)};
+        return Dict<T, Alloc>::ins(letters) && writeRecord(Op::ins, letters);
+      }
+      ///  Erase an item and write it to the journal
+      template <radix_dict::WordOf<T> W> bool erase(const W& word) {
+        auto letters {radix_dict::wordSpan<T>(word)};
+        return Dict<T, Alloc>::erase(letters) && writeRecord(Op::erase, letters);
+      }
+      ///  Remove all items and write it to the journal
+      void clear() {
+        Dict<T, Alloc>::clear();
+        writeRecord(Op::clear, {});
+      }
+      using Dict<T, Alloc>::get;
+      using Dict<T, Alloc>::get_view;
+      using Dict<T, Alloc>::get_to;
+      using Dict<T, Alloc>::contains;
+      using Dict<T, Alloc>::fuzzy_get;
+      using Dict<T, Alloc>::get_batch;
+      using Dict<T, Alloc>::completions;
+      using Dict<T, Alloc>::count_prefix;
+      using Dict<T, Alloc>::is_unique;
+      using Dict<T, Alloc>::kth;
+      using Dict<T, Alloc>::rank;
+      using Dict<T, Alloc>::cursor;
+      using Dict<T, Alloc>::freeze;
+      using Dict<T, Alloc>::save;
+      using Dict<T, Alloc>::stats;
+      using Dict<T, Alloc>::counters;
+  };
+
+  ///  Dictionary shared by many threads, see radix_dict::ConcurrentRadixTree
+  template <typename T> class ConcurrentDict : public radix_dict::ConcurrentRadixTree<T> {
+    private :
+      T delim;
+    public :
+      ///  Creating an empty dictionary container with a delimetr
+      explicit ConcurrentDict (const T delim) : delim{delim} {}
+      ///  Creating a dictionary container with a delimetr by a list of items
+      ConcurrentDict (const T delim, std::initializer_list<vector<T>> init_lst) : ConcurrentDict (delim) {
+        for (const auto& comm : init_lst) {
+          ins(comm);
+        }
+      }
+      ///  Insert a new item, readers are not blocked. Returns false for an item in the container already, throws
+      ///  std::length_error if the nodes storage is full
+      template <radix_dict::WordOf<T> W> bool ins(const W& word) {
+        auto parts {divide(radix_dict::wordSpan<T>(word), delim)};
+        return !parts.pre.empty() && this->insPublish(parts.pre, parts.post);
+      }
+      ///  Get an item from container, the tree walk is wait-free but the result is allocated
+      template <radix_dict::WordOf<T> W> [[nodiscard]] unique_ptr<vector<T>> get(const W& word) const {
+        radix_dict::EpochDomain::Guard guard {this->epochs};
+        return completeItem(this->store, this->root.load(std::memory_order_seq_cst), delim, radix_dict::wordSpan<T>(word));
+      }
+      ///  Write an item to an output iterator, wait-free - nothing is allocated writing to a buffer of enough size.
+      ///  Returns an iterator past the item, nothing is written for a missing item
+      template <radix_dict::WordOf<T> W, std::output_iterator<const T&> Out> std::optional<Out> get_to(const W& word, Out out) const {
+        radix_dict::EpochDomain::Guard guard {this->epochs};
+        auto view {viewItem(this->store, this->root.load(std::memory_order_seq_cst), delim, radix_dict::wordSpan<T>(word))};
+        if (!view) {
+          return std::nullopt;
+        }
+        return view->copy(std::move(out));
+      }
+      ///  Check if exactly this item is in container, wait-free
+      template <radix_dict::WordOf<T> W> [[nodiscard]] bool contains(const W& word) const noexcept {
+        radix_dict::EpochDomain::Guard guard {this->epochs};
+        return containsItem(this->store, this->root.load(std::memory_order_seq_cst), delim, radix_dict::wordSpan<T>(word));
+      }
   };
 
+  ///  Dictionaries with all memory taken from a std::pmr::memory_resource
+  namespace pmr {
+    template <typename T> using Dict = cli_dict::Dict<T, std::pmr::polymorphic_allocator<T>>;
+    template <typename T> using HierDict = cli_dict::HierDict<T, std::pmr::polymorphic_allocator<T>>;
+    template <typename T, typename V> using DictMap = cli_dict::DictMap<T, V, std::pmr::polymorphic_allocator<T>>;
+  }
 }
 
-#endif
\ No newline at end of file
+#endif
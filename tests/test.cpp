@@ -3,8 +3,13 @@
 
 #include <variant>
 #include <iostream>
-#include "../clio.h"
-#include "../dict.h"
+#include <thread>
+#include <random>
+#include <memory_resource>
+#include <atomic>
+#include <array>
+#include <functional>
+#include "clidict.hpp"
 
 using namespace testing;
 using namespace radix_dict;
@@ -263,6 +268,1360 @@ TEST(TestIitList, DictDict){
   EXPECT_THAT(*res12, ContainerEq(s2)); 
 }
 
+TEST(TestArena, ManyCommands){
+  RadixTree<char> radix;
+  vector<vector<char>> words;
+  for (int count = 0; count < 5000; ++count) {
+    auto str {std::to_string(count * 7919 % 100003)};
+    words.emplace_back(str.begin(), str.end());
+    words.back().push_back('x');
+  }
+  for (auto word : words) {
+    radix.ins(std::move(word));
+  }
+  for (auto& word : words) {
+    auto res = radix.get(vector<char>(word));
+    ASSERT_TRUE(res);
+    EXPECT_THAT(*res, ContainerEq(word));
+  }
+  EXPECT_FALSE(radix.ins(vector<char>(words.front())));
+
+  radix.clear();
+  EXPECT_FALSE(radix.get(vector<char>(words.front())));
+  EXPECT_TRUE(radix.ins(vector<char>(words.front())));
+  EXPECT_THAT(*radix.get(vector<char>(words.front())), ContainerEq(words.front()));
+}
+
+TEST(TestViews, RadixViews){
+  RadixTree<char> radix {{'t', 'e', 's', 't', '1'}, {'t', 'e', 's', 't', '2'}};
+  EXPECT_TRUE(radix.ins(std::string_view{"tell"}));
+  EXPECT_FALSE(radix.ins(std::string{"tell"}));
+
+  auto res1 = radix.get("tes");
+  EXPECT_THAT(*res1, ContainerEq(vector<char>{'t', 'e', 's', 't'}));
+  const char letters[] {'t', 'e', 'l'};
+  auto res2 = radix.get(span<const char>{letters});
+  EXPECT_THAT(*res2, ContainerEq(vector<char>{'t', 'e', 'l', 'l'}));
+  EXPECT_FALSE(radix.get("tx"));
+  EXPECT_FALSE(radix.get("test12"));
+
+  EXPECT_TRUE(radix.contains("test1"));
+  EXPECT_TRUE(radix.contains(std::string{"tell"}));
+  EXPECT_FALSE(radix.contains("test"));
+  EXPECT_FALSE(radix.contains("te"));
+  EXPECT_FALSE(radix.contains(""));
+
+  RadixTree<int> numbers {{1, 2, 3}, {1, 2, 4}};
+  const vector<int> num {1, 2};
+  EXPECT_TRUE(numbers.contains(vector<int>{1, 2, 3}));
+  EXPECT_FALSE(numbers.contains(num));
+  EXPECT_THAT(*numbers.get(num), ContainerEq(num));
+}
+
+TEST(TestViews, DictViews){
+  Dict<char> dict {'-', {{'t', 'e', 's', 't', '1', '-', 'a', 'b'}, {'t', 'e', 's', 't', '2'}}};
+  EXPECT_TRUE(dict.ins("test2-cd"));
+  EXPECT_FALSE(dict.ins(std::string_view{"test2-cd"}));
+
+  auto res1 = dict.get("test1-a");
+  EXPECT_THAT(*res1, ContainerEq(vector<char>{'t', 'e', 's', 't', '1', '-', 'a', 'b'}));
+  auto res2 = dict.get(std::string{"test2-c"});
+  EXPECT_THAT(*res2, ContainerEq(vector<char>{'t', 'e', 's', 't', '2', '-', 'c', 'd'}));
+  EXPECT_FALSE(dict.get("test-a"));
+  EXPECT_FALSE(dict.get("test1-x"));
+  EXPECT_FALSE(dict.get("-ab"));
+
+  EXPECT_TRUE(dict.contains("test1-ab"));
+  EXPECT_TRUE(dict.contains("test2"));
+  EXPECT_TRUE(dict.contains("test2-cd"));
+  EXPECT_FALSE(dict.contains("test1"));
+  EXPECT_FALSE(dict.contains("test1-a"));
+  EXPECT_FALSE(dict.contains("test"));
+}
+
+TEST(TestBranches, FanOut){
+  RadixTree<char> radix;
+  for (int letter = -128; letter < 128; ++letter) {
+    EXPECT_TRUE(radix.ins(vector<char>{'c', 'm', 'd', static_cast<char>(letter), 'x'}));
+    for (int prev = -128; prev <= letter; prev += 17) {
+      ASSERT_TRUE(radix.contains(vector<char>{'c', 'm', 'd', static_cast<char>(prev), 'x'}));
+    }
+  }
+  for (int letter = -128; letter < 128; ++letter) {
+    auto res = radix.get(vector<char>{'c', 'm', 'd', static_cast<char>(letter)});
+    ASSERT_TRUE(res);
+    EXPECT_THAT(*res, ContainerEq(vector<char>{'c', 'm', 'd', static_cast<char>(letter), 'x'}));
+  }
+  EXPECT_THAT(*radix.get("c"), ContainerEq(vector<char>{'c', 'm', 'd'}));
+
+  RadixTree<char16_t> wide;
+  for (char16_t letter = 0x400; letter < 0x440; ++letter) {
+    EXPECT_TRUE(wide.ins(std::u16string{u"ab"} + letter));
+  }
+  for (char16_t letter = 0x400; letter < 0x440; ++letter) {
+    EXPECT_TRUE(wide.contains(std::u16string{u"ab"} + letter));
+  }
+  EXPECT_FALSE(wide.contains(u"ab\u0440"));
+}
+
+TEST(TestImage, FrozenRadix){
+  RadixTree<char> radix {{'t', 'e', 's', 't', '1'}, {'t', 'e', 's', 't', '2'}, {'t', 'e', 'l', 'l'}, {'a'}};
+  auto image = radix.freeze();
+  FrozenTree<char> frozen {image};
+  ASSERT_TRUE(frozen.valid());
+  for (std::string_view word : {"t", "te", "tes", "test1", "test2", "tel", "a", "b", "tx", "test12"}) {
+    auto res = radix.get(word);
+    auto frozen_res = frozen.get(word);
+    ASSERT_EQ(static_cast<bool>(res), static_cast<bool>(frozen_res));
+    if (res) {
+      EXPECT_THAT(*frozen_res, ContainerEq(*res));
+    }
+    EXPECT_EQ(radix.contains(word), frozen.contains(word));
+  }
+  EXPECT_FALSE(FrozenDict<char>{image}.valid());
+
+  image.front() = std::byte{'X'};
+  EXPECT_FALSE(FrozenTree<char>{image}.valid());
+  EXPECT_FALSE(FrozenTree<char>{}.get("t"));
+}
+
+TEST(TestImage, MappedDict){
+  Dict<char> dict {'-', {{'t', 'e', 's', 't', '1', '-', 't', 'e', 's', 't', '1'}, {'t', 'e', 's', 't', '2', '-', 't', 'e', 's', 't', '2'}}};
+  for (int count = 0; count < 300; ++count) {
+    dict.ins("cmd" + std::to_string(count) + "-opt" + std::to_string(count % 7));
+  }
+  auto path = std::filesystem::temp_directory_path() / "clidict_test.img";
+  ASSERT_TRUE(dict.save(path));
+
+  MappedImage file {path};
+  ASSERT_TRUE(file);
+  FrozenDict<char> frozen {file.bytes()};
+  ASSERT_TRUE(frozen.valid());
+  EXPECT_THAT(*frozen.get("test1-t"), ContainerEq(*dict.get("test1-t")));
+  EXPECT_THAT(*frozen.get("t"), ContainerEq(*dict.get("t")));
+  EXPECT_FALSE(frozen.get("test-t"));
+  for (int count = 0; count < 300; ++count) {
+    auto word = "cmd" + std::to_string(count) + "-opt" + std::to_string(count % 7);
+    EXPECT_TRUE(frozen.contains(word));
+    auto abbrev = word.substr(0, word.size() - 1);
+    EXPECT_THAT(*frozen.get(abbrev), ContainerEq(*dict.get(abbrev)));
+  }
+  EXPECT_FALSE(frozen.contains("cmd1"));
+
+  //  Damaged files are not mapped, in memory images are checked by validate
+  auto image {dict.freeze()};
+  auto head {reinterpret_cast<ImageHeader*>(image.data())};
+  auto nodes {reinterpret_cast<ImageNode*>(image.data() + head->nodes_offset)};
+  auto branch_nodes {reinterpret_cast<node_id*>(image.data() + head->branch_nodes_offset)};
+  auto write = [&path](span<const std::byte> bytes){return saveImage(path, bytes) && static_cast<bool>(MappedImage{path});};
+  EXPECT_TRUE(write(image));
+  EXPECT_FALSE(write(span<const std::byte>{image}.first(image.size() / 2)));
+  for (auto damage : std::initializer_list<std::function<void()>>{
+         [&]{nodes[1].letters_len = head->letters_count + 1;},
+         [&]{nodes[head->root].branches_pos = head->branches_count;},
+         [&]{nodes[2].postfix_tree = head->nodes_count;},
+         [&]{branch_nodes[3] = head->nodes_count + 5;},
+         [&]{branch_nodes[0] = head->root;},
+         [&]{head->letters_offset = std::numeric_limits<std::uint64_t>::max() - 2;}}) {
+    auto saved {image};
+    damage();
+    ImageView<char> view {image};
+    EXPECT_FALSE(view.validate());
+    EXPECT_FALSE(view.head());
+    EXPECT_FALSE(write(image));
+    ranges::copy(saved, image.begin());
+  }
+  ImageView<char> view {image};
+  EXPECT_TRUE(view.validate());
+  std::filesystem::remove(path);
+}
+
+TEST(TestSorted, RadixSorted){
+  vector<std::string> words;
+  for (int count = 0; count < 2000; ++count) {
+    words.push_back("cmd" + std::to_string(count * 31 % 1777));
+  }
+  words.push_back("c");
+  words.push_back("cm");
+  std::sort(words.begin(), words.end());
+
+  auto sorted = RadixTree<char>::build_sorted(words);
+  RadixTree<char> radix;
+  for (auto& word : words) {
+    radix.ins(word);
+  }
+  for (auto& word : words) {
+    EXPECT_TRUE(sorted.contains(word));
+    for (size_t len = 1; len <= word.size(); ++len) {
+      auto prefix = std::string_view{word}.substr(0, len);
+      EXPECT_THAT(*sorted.get(prefix), ContainerEq(*radix.get(prefix)));
+    }
+  }
+  EXPECT_FALSE(sorted.contains("cmd"));
+
+  vector<std::string_view> unsorted {"b", "test2", "test1", "a", "test"};
+  auto fallback = RadixTree<char>::build_sorted(unsorted);
+  for (auto word : unsorted) {
+    EXPECT_TRUE(fallback.contains(word));
+  }
+  EXPECT_THAT(*fallback.get("t"), ContainerEq(vector<char>{'t', 'e', 's', 't'}));
+}
+
+TEST(TestSorted, Utf8Sorted){
+  //  UTF-8 and high bytes are sorted after ASCII by std::sort, both at node16 and at node48 / node256 branches
+  vector<std::string> words {"zeta", "\xc3\xbc" "ber", "na\xc3\xafve", "naive", "\xc3\xa4rger", "abc"};
+  for (int byte = 2; byte < 256; byte += 3) {
+    words.push_back(std::string(1, static_cast<char>(byte)) + "x");
+  }
+  for (int byte = 0x60; byte < 0xa0; ++byte) {
+    words.push_back("m" + std::string(1, static_cast<char>(byte)));
+  }
+  std::sort(words.begin(), words.end());
+
+  auto sorted = RadixTree<char>::build_sorted(words);
+  RadixTree<char> radix;
+  for (auto& word : words) {
+    radix.ins(word);
+  }
+  vector<std::string> res;
+  for (auto word : sorted.completions("")) {
+    res.emplace_back(word.begin(), word.end());
+  }
+  EXPECT_THAT(res, ContainerEq(words));
+  auto image {sorted.freeze()};
+  FrozenTree<char> frozen {image};
+  for (auto& word : words) {
+    EXPECT_TRUE(frozen.contains(word));
+  }
+  EXPECT_EQ(sorted.stats().nodes, radix.stats().nodes);
+  EXPECT_EQ(sorted.rank("\xc3\xa4rger"), static_cast<size_t>(ranges::find(words, "\xc3\xa4rger") - words.begin()));
+#if defined(CLIDICT_STATS)
+  //  No word falls back to one by one inserts
+  EXPECT_EQ(sorted.counters().inserts, 0u);
+#endif
+}
+
+TEST(TestSorted, DictSorted){
+  vector<std::string> items {"test1", "test1-test1", "test1-test2", "test2-test2", "test3", "test3-a", "test3-ab", "tool-x"};
+  auto dict = Dict<char>::build_sorted('-', items);
+  for (auto& item : items) {
+    EXPECT_TRUE(dict.contains(item));
+  }
+  EXPECT_FALSE(dict.contains("test2"));
+  EXPECT_THAT(*dict.get("to-"), ContainerEq(vector<char>{'t', 'o', 'o', 'l', '-'}));
+  EXPECT_THAT(*dict.get("test1-test"), ContainerEq(vector<char>{'t', 'e', 's', 't', '1', '-', 't', 'e', 's', 't'}));
+  EXPECT_THAT(*dict.get("test3-a"), ContainerEq(vector<char>{'t', 'e', 's', 't', '3', '-', 'a'}));
+
+  vector<std::string> unsorted {"a!x", "a-b", "a-c"};
+  auto fallback = Dict<char>::build_sorted('-', unsorted);
+  for (auto& item : unsorted) {
+    EXPECT_TRUE(fallback.contains(item));
+  }
+}
+
+TEST(TestCompletions, RadixCompletions){
+  RadixTree<char> radix {{'t', 'e', 's', 't'}, {'t', 'e', 's', 't', '2'}, {'t', 'e', 's', 't', '1'}, {'t', 'e', 'l', 'l'}, {'a'}};
+  vector<std::string> res;
+  for (auto word : radix.completions("te")) {
+    res.emplace_back(word.begin(), word.end());
+  }
+  EXPECT_THAT(res, ElementsAre("tell", "test", "test1", "test2"));
+
+  res.clear();
+  for (auto word : radix.completions("", 2)) {
+    res.emplace_back(word.begin(), word.end());
+  }
+  EXPECT_THAT(res, ElementsAre("a", "tell"));
+  EXPECT_EQ(ranges::distance(radix.completions("tes")), 3);
+  EXPECT_EQ(ranges::distance(radix.completions("tx")), 0);
+  EXPECT_EQ(ranges::distance(radix.completions("test12")), 0);
+
+  RadixTree<char> big;
+  for (int count = 0; count < 50000; ++count) {
+    big.ins("cmd" + std::to_string(count));
+  }
+  res.clear();
+  for (auto word : big.completions("cmd1", 20)) {
+    res.emplace_back(word.begin(), word.end());
+  }
+  ASSERT_EQ(res.size(), 20u);
+  EXPECT_EQ(res[0], "cmd1");
+  EXPECT_EQ(res[1], "cmd10");
+  EXPECT_EQ(res[2], "cmd100");
+  EXPECT_TRUE(ranges::is_sorted(res));
+}
+
+TEST(TestCompletions, DictCompletions){
+  Dict<char> dict {'-', {{'t', 'e', 's', 't', '1', '-', 'a', 'b'}, {'t', 'e', 's', 't', '1', '-', 'a', 'c'}, {'t', 'e', 's', 't', '1'},
+                         {'t', 'e', 's', 't', '1', '0'}, {'t', 'e', 's', 't', '2', '-', 'x'}}};
+  vector<std::string> res;
+  for (auto word : dict.completions("test")) {
+    res.emplace_back(word.begin(), word.end());
+  }
+  EXPECT_THAT(res, ElementsAre("test1", "test1-ab", "test1-ac", "test10", "test2-x"));
+
+  res.clear();
+  for (auto word : dict.completions("test1-")) {
+    res.emplace_back(word.begin(), word.end());
+  }
+  EXPECT_THAT(res, ElementsAre("test1-ab", "test1-ac"));
+
+  res.clear();
+  for (auto word : dict.completions("test1-ac")) {
+    res.emplace_back(word.begin(), word.end());
+  }
+  EXPECT_THAT(res, ElementsAre("test1-ac"));
+  EXPECT_EQ(ranges::distance(dict.completions("tes-")), 0);
+  EXPECT_EQ(ranges::distance(dict.completions("test1-x")), 0);
+}
+
+TEST(TestConcurrent, RadixReadersWriter){
+  ConcurrentRadixTree<char> radix {{'t', 'e', 's', 't'}, {'a'}};
+  EXPECT_FALSE(radix.ins("test"));
+  EXPECT_TRUE(radix.ins("te"));
+  EXPECT_TRUE(radix.contains("te"));
+  EXPECT_THAT(*radix.get("tes"), ContainerEq(vector<char>{'t', 'e', 's', 't'}));
+
+  constexpr int words_count {3000};
+  std::atomic<bool> done {false};
+  std::atomic<int> errors {0};
+  vector<std::thread> readers;
+  for (int reader = 0; reader < 3; ++reader) {
+    readers.emplace_back([&]{
+      while (!done.load()) {
+        for (int count = 0; count < words_count; count += 97) {
+          auto word {"cmd" + std::to_string(count)};
+          auto res {radix.get(word)};
+          if (res && !std::string(res->begin(), res->end()).starts_with(word)) {
+            ++errors;
+          }
+          std::array<char, 32> buffer {};
+          auto end {radix.get_to(word, buffer.begin())};
+          if (end && !std::string(buffer.begin(), *end).starts_with(word)) {
+            ++errors;
+          }
+          if (!radix.contains("test")) {
+            ++errors;
+          }
+        }
+      }
+    });
+  }
+  for (int count = 0; count < words_count; ++count) {
+    radix.ins("cmd" + std::to_string(count));
+  }
+  done = true;
+  ranges::for_each(readers, [](auto& reader){reader.join();});
+  EXPECT_EQ(errors.load(), 0);
+  radix.reclaim();
+  for (int count = 0; count < words_count; ++count) {
+    EXPECT_TRUE(radix.contains("cmd" + std::to_string(count)));
+  }
+}
+
+TEST(TestConcurrent, DictReadersWriter){
+  ConcurrentDict<char> dict {'-', {{'t', 'e', 's', 't', '1', '-', 'a', 'b'}, {'t', 'e', 's', 't', '2'}}};
+  std::atomic<bool> done {false};
+  std::atomic<int> errors {0};
+  std::thread reader {[&]{
+    while (!done.load()) {
+      auto res {dict.get("test1-a")};
+      if (!res || std::string(res->begin(), res->end()) != "test1-ab") {
+        ++errors;
+      }
+      std::array<char, 32> buffer {};
+      auto end {dict.get_to("test2-", buffer.begin())};
+      if (!end || std::string(buffer.begin(), *end) != "test2-") {
+        ++errors;
+      }
+    }
+  }};
+  for (int count = 0; count < 500; ++count) {
+    dict.ins("test" + std::to_string(count) + "-opt" + std::to_string(count));
+  }
+  done = true;
+  reader.join();
+  EXPECT_EQ(errors.load(), 0);
+  EXPECT_TRUE(dict.contains("test1-ab"));
+  EXPECT_TRUE(dict.contains("test7-opt7"));
+  EXPECT_TRUE(dict.contains("test2"));
+  EXPECT_FALSE(dict.contains("test7-opt"));
+  EXPECT_THAT(*dict.get("test499-o"), ContainerEq(vector<char>{'t', 'e', 's', 't', '4', '9', '9', '-', 'o', 'p', 't', '4', '9', '9'}));
+  std::string item(32, '\0');
+  auto end {dict.get_to("test49-o", item.begin())};
+  ASSERT_TRUE(end);
+  EXPECT_EQ(std::string(item.begin(), *end), "test49-opt49");
+  EXPECT_FALSE(dict.get_to("test49-x", item.begin()));
+}
+
+TEST(TestBatch, RadixBatch){
+  RadixTree<char> radix;
+  for (int count = 0; count < 5000; ++count) {
+    radix.ins("cmd" + std::to_string(count * 7));
+  }
+  vector<std::string> words {"cmd7", "cmd70", "cmd", "x", "", "cmd34993", "cmd349930", "cmd14", "c"};
+  vector<unique_ptr<vector<char>>> results(words.size());
+  size_t found {radix.get_batch(span<const std::string>{words}, span{results})};
+  EXPECT_EQ(found, static_cast<size_t>(ranges::count_if(words, [&radix](const auto& word){return radix.get(word) != nullptr;})));
+  for (size_t pos = 0; pos < words.size(); ++pos) {
+    auto single {radix.get(words[pos])};
+    ASSERT_EQ(results[pos] == nullptr, single == nullptr) << words[pos];
+    if (single) {
+      EXPECT_THAT(*results[pos], ContainerEq(*single));
+    }
+  }
+}
+
+TEST(TestBatch, DictBatch){
+  Dict<char> dict {'-', {{'t', 'e', 's', 't', '1', '-', 'a', 'b'}, {'t', 'e', 's', 't', '1', '-', 'a', 'c'}, {'t', 'e', 's', 't', '2'},
+                         {'t', 'e', 's', 't', '3', '-', 'x', 'y'}}};
+  vector<std::string_view> words {"test1-ab", "test1-a", "test3-", "test3-x", "test2-x", "test2", "tesx", "-a", "test3-xz"};
+  vector<unique_ptr<vector<char>>> results(words.size());
+  dict.get_batch(span<const std::string_view>{words}, span{results});
+  for (size_t pos = 0; pos < words.size(); ++pos) {
+    auto single {dict.get(words[pos])};
+    ASSERT_EQ(results[pos] == nullptr, single == nullptr) << words[pos];
+    if (single) {
+      EXPECT_THAT(*results[pos], ContainerEq(*single));
+    }
+  }
+}
+
+TEST(TestHierDict, Levels){
+  HierDict<char> cmd {' '};
+  EXPECT_TRUE(cmd.ins("tool sub action"));
+  EXPECT_TRUE(cmd.ins("tool sub list"));
+  EXPECT_TRUE(cmd.ins("tool other"));
+  EXPECT_TRUE(cmd.ins(std::string_view{"git commit --amend"}));
+  EXPECT_TRUE(cmd.ins("tool"));
+  EXPECT_FALSE(cmd.ins("tool sub list"));
+  EXPECT_FALSE(cmd.ins("tool  sub"));
+  EXPECT_FALSE(cmd.ins(" tool"));
+  EXPECT_FALSE(cmd.ins("tool "));
+
+  auto as_string = [](const auto& res){return res ? std::string(res->begin(), res->end()) : std::string{"null"};};
+  EXPECT_EQ(as_string(cmd.get("t s a")), "tool sub action");
+  EXPECT_EQ(as_string(cmd.get("t s l")), "tool sub list");
+  EXPECT_EQ(as_string(cmd.get("t o")), "tool other");
+  EXPECT_EQ(as_string(cmd.get("g c --a")), "git commit --amend");
+  EXPECT_EQ(as_string(cmd.get("t s ")), "tool sub ");
+  EXPECT_EQ(as_string(cmd.get("t")), "tool");
+  EXPECT_EQ(as_string(cmd.get("t s x")), "null");
+  EXPECT_EQ(as_string(cmd.get("t s a b")), "null");
+  EXPECT_EQ(as_string(cmd.get("t  s")), "null");
+  EXPECT_EQ(as_string(cmd.get("")), "null");
+
+  EXPECT_TRUE(cmd.contains("tool sub action"));
+  EXPECT_TRUE(cmd.contains("tool"));
+  EXPECT_FALSE(cmd.contains("tool sub"));
+  EXPECT_FALSE(cmd.contains("t s a"));
+  EXPECT_FALSE(cmd.contains("git commit"));
+
+  HierDict<char> init {'-', {{'a', '-', 'b', '-', 'c'}, {'a', '-', 'd'}}};
+  EXPECT_TRUE(init.contains("a-b-c"));
+  EXPECT_EQ(as_string(init.get("a-d")), "a-d");
+}
+
+TEST(TestHierDict, LevelQueries){
+  HierDict<char> cmd {' ', {{'t', 'o', 'o', 'l'}}};
+  for (const auto item : {"tool sub action", "tool sub list", "tool other", "tool sub", "git commit --amend", "git clone"}) {
+    EXPECT_TRUE(cmd.ins(item));
+  }
+  auto as_string = [](const auto& res){return res ? std::string(res->begin(), res->end()) : std::string{"null"};};
+
+  std::vector<std::string> all;
+  for (auto item : cmd.completions("t")) {
+    all.emplace_back(item.begin(), item.end());
+  }
+  EXPECT_EQ(all, (std::vector<std::string>{"tool", "tool other", "tool sub", "tool sub action", "tool sub list"}));
+  all.clear();
+  for (auto item : cmd.completions("tool sub l")) {
+    all.emplace_back(item.begin(), item.end());
+  }
+  EXPECT_EQ(all, (std::vector<std::string>{"tool sub list"}));
+  EXPECT_EQ(ranges::distance(cmd.completions("t sub")), 0);
+  EXPECT_EQ(ranges::distance(cmd.completions("g", 1)), 1);
+
+  auto fuzzy {cmd.fuzzy_get("tool sub acton", 1)};
+  ASSERT_EQ(fuzzy.size(), 1u);
+  EXPECT_EQ(std::string(fuzzy.front().word.begin(), fuzzy.front().word.end()), "tool sub action");
+  EXPECT_EQ(fuzzy.front().distance, 1u);
+  EXPECT_EQ(cmd.fuzzy_get("git clone", 0).size(), 1u);
+  EXPECT_EQ(cmd.fuzzy_get("tool sub", 5).size(), 4u);  //  tool sub, tool, tool other, tool sub list
+
+  vector<std::string> words {"t s a", "t s l", "t s", "t s ", "t", "g c --a", "g cl", "g c", "t s x", "t s a b", "t  s", " t", "", "x", "t o "};
+  vector<unique_ptr<vector<char>>> results(words.size());
+  size_t found {cmd.get_batch(span<const std::string>{words}, span{results})};
+  EXPECT_EQ(found, static_cast<size_t>(ranges::count_if(words, [&cmd](const auto& word){return cmd.get(word) != nullptr;})));
+  for (size_t pos = 0; pos < words.size(); ++pos) {
+    EXPECT_EQ(as_string(results[pos]), as_string(cmd.get(words[pos]))) << words[pos];
+  }
+  EXPECT_EQ(as_string(results[0]), "tool sub action");
+
+  auto image {cmd.freeze()};
+  FrozenHierDict<char> frozen {image};
+  ASSERT_TRUE(frozen.valid());
+  for (const auto& word : words) {
+    EXPECT_EQ(as_string(frozen.get(word)), as_string(cmd.get(word))) << word;
+  }
+  EXPECT_TRUE(frozen.contains("tool sub action"));
+  EXPECT_TRUE(frozen.contains("tool"));
+  EXPECT_FALSE(frozen.contains("tool sub action x"));
+  EXPECT_FALSE(frozen.contains("git commit"));
+  EXPECT_FALSE(FrozenDict<char>{image}.valid());
+  EXPECT_FALSE(FrozenTree<char>{image}.valid());
+  EXPECT_FALSE(FrozenHierDict<char>{Dict<char>{' '}.freeze()}.valid());
+}
+
+TEST(TestStats, TreeShape){
+  Dict<char> dict {'-', {{'t', 'e', 's', 't', '1', '-', 'a', 'b'}, {'t', 'e', 's', 't', '1', '-', 'a', 'c'}, {'t', 'e', 's', 't', '2'},
+                         {'a'}}};
+  auto stats {dict.stats()};
+  //  Root, a, test, 1, 2, postfix root, a, b, c
+  EXPECT_EQ(stats.nodes, 9u);
+  EXPECT_EQ(stats.words, 4u);
+  EXPECT_EQ(stats.postfix_trees, 1u);
+  EXPECT_EQ(stats.max_depth, 5u);
+  EXPECT_THAT(stats.depth_nodes, ElementsAre(1, 2, 2, 1, 1, 2));
+  EXPECT_EQ(stats.max_fanout, 2u);
+  EXPECT_THAT(stats.fanout_nodes, ElementsAre(5, 1, 3));
+  EXPECT_EQ(stats.kind_nodes[static_cast<size_t>(BranchKind::node4)], 4u);
+  EXPECT_GT(stats.letters_bytes, 0u);
+  EXPECT_GT(stats.branches_bytes, 0u);
+  EXPECT_GT(stats.nodes_bytes, 0u);
+
+  EXPECT_TRUE(dict.get("te"));
+  EXPECT_FALSE(dict.get("x"));
+  auto counters {dict.counters()};
+#if defined(CLIDICT_STATS)
+  EXPECT_EQ(counters.inserts, 4u);
+  EXPECT_EQ(counters.lookups, 2u);
+  EXPECT_EQ(counters.failed_lookups, 1u);
+  EXPECT_GT(counters.levels, 0u);
+  EXPECT_GT(counters.splits, 0u);
+#else
+  EXPECT_EQ(counters.lookups, 0u);
+  EXPECT_EQ(counters.levels, 0u);
+#endif
+}
+
+TEST(TestErase, RadixErase){
+  RadixTree<char> radix {{'t', 'e', 's', 't'}, {'t', 'e', 's', 't', '1'}, {'t', 'e', 'l', 'l'}, {'a'}};
+  EXPECT_FALSE(radix.erase("tes"));
+  EXPECT_FALSE(radix.erase("test12"));
+  EXPECT_TRUE(radix.erase("tell"));
+  EXPECT_FALSE(radix.erase("tell"));
+  EXPECT_FALSE(radix.contains("tell"));
+  EXPECT_TRUE(radix.contains("test"));
+  //  "te" is joined back with "st"
+  EXPECT_THAT(*radix.get("t"), ContainerEq(vector<char>{'t', 'e', 's', 't'}));
+  EXPECT_EQ(radix.stats().nodes, 4u);
+  EXPECT_TRUE(radix.erase("test"));
+  EXPECT_THAT(*radix.get("t"), ContainerEq(vector<char>{'t', 'e', 's', 't', '1'}));
+  EXPECT_EQ(radix.stats().nodes, 3u);
+
+  //  Churn - erased nodes are reused, compaction drops stale labels and sets
+  RadixTree<char> churn;
+  for (int round = 0; round < 3; ++round) {
+    for (int count = 0; count < 2000; ++count) {
+      churn.ins("cmd" + std::to_string(count));
+    }
+    for (int count = 0; count < 2000; count += round + 1) {
+      EXPECT_TRUE(churn.erase("cmd" + std::to_string(count)));
+    }
+  }
+  auto before {churn.stats()};
+  churn.compact();
+  auto after {churn.stats()};
+  EXPECT_EQ(before.nodes, after.nodes);
+  EXPECT_EQ(before.words, after.words);
+  EXPECT_LT(after.letters_bytes, before.letters_bytes);
+  for (int count = 0; count < 2000; ++count) {
+    EXPECT_EQ(churn.contains("cmd" + std::to_string(count)), count % 3 != 0) << count;
+  }
+  EXPECT_TRUE(churn.ins("cmd0"));
+  EXPECT_TRUE(churn.contains("cmd0"));
+}
+
+TEST(TestErase, DictErase){
+  Dict<char> dict {'-', {{'t', 'e', 's', 't', '1', '-', 'a', 'b'}, {'t', 'e', 's', 't', '1', '-', 'a', 'c'}, {'t', 'e', 's', 't', '2'}}};
+  EXPECT_FALSE(dict.erase("test1-a"));
+  EXPECT_FALSE(dict.erase("test1"));
+  EXPECT_TRUE(dict.erase("test1-ab"));
+  EXPECT_TRUE(dict.contains("test1-ac"));
+  EXPECT_THAT(*dict.get("test1-a"), ContainerEq(vector<char>{'t', 'e', 's', 't', '1', '-', 'a', 'c'}));
+  EXPECT_TRUE(dict.erase("test1-ac"));
+  //  Empty postfix tree and unneeded pre part node are gone, test and 2 are joined
+  EXPECT_EQ(dict.stats().postfix_trees, 0u);
+  EXPECT_THAT(*dict.get("t"), ContainerEq(vector<char>{'t', 'e', 's', 't', '2'}));
+
+  HierDict<char> cmd {' '};
+  cmd.ins("tool sub action");
+  cmd.ins("tool sub list");
+  EXPECT_FALSE(cmd.erase("tool sub"));
+  EXPECT_TRUE(cmd.erase("tool sub action"));
+  EXPECT_EQ(cmd.stats().postfix_trees, 2u);
+  EXPECT_TRUE(cmd.erase("tool sub list"));
+  EXPECT_EQ(cmd.stats().nodes, 1u);
+}
+
+TEST(TestFuzzy, RadixFuzzy){
+  RadixTree<char> radix;
+  vector<std::string> words {"status", "stash", "start", "stop", "commit", "checkout", "cherry-pick", "clone", "config"};
+  for (const auto& word : words) {
+    radix.ins(word);
+  }
+  auto as_strings = [](const auto& found) {
+    vector<std::string> res;
+    for (const auto& match : found) {
+      res.emplace_back(match.word.begin(), match.word.end());
+    }
+    return res;
+  };
+  EXPECT_THAT(as_strings(radix.fuzzy_get("stauts", 2)), ElementsAre("start", "status"));
+  EXPECT_THAT(as_strings(radix.fuzzy_get("stat", 1)), ElementsAre("start"));
+  EXPECT_THAT(as_strings(radix.fuzzy_get("cmmit", 1)), ElementsAre("commit"));
+  EXPECT_TRUE(radix.fuzzy_get("xyzzy", 2).empty());
+  auto found {radix.fuzzy_get("stat", 2, 2)};
+  ASSERT_EQ(found.size(), 2u);
+  EXPECT_EQ(found[0].distance, 1u);
+  EXPECT_EQ(std::string(found[0].word.begin(), found[0].word.end()), "start");
+
+  //  Same items as a linear Levenshtein scan
+  auto distance = [](const std::string& left, const std::string& right) {
+    vector<size_t> row(right.size() + 1);
+    std::iota(row.begin(), row.end(), size_t{0});
+    for (size_t pos = 1; pos <= left.size(); ++pos) {
+      size_t diag {row[0]};
+      row[0] = pos;
+      for (size_t other = 1; other <= right.size(); ++other) {
+        size_t up {row[other]};
+        row[other] = std::min({row[other] + 1, row[other - 1] + 1, diag + (left[pos - 1] != right[other - 1])});
+        diag = up;
+      }
+    }
+    return row.back();
+  };
+  for (const std::string query : {"sta", "chckout", "confg", "clon", "s"}) {
+    vector<std::string> expected;
+    for (const auto& word : words) {
+      if (distance(query, word) <= 2) {
+        expected.push_back(word);
+      }
+    }
+    auto res {as_strings(radix.fuzzy_get(query, 2))};
+    EXPECT_THAT(res, UnorderedElementsAreArray(expected)) << query;
+  }
+}
+
+TEST(TestFuzzy, DictFuzzy){
+  Dict<char> dict {' ', {{'g', 'i', 't', ' ', 'p', 'u', 's', 'h'}, {'g', 'i', 't', ' ', 'p', 'u', 'l', 'l'}, {'g', 'o'}}};
+  auto found {dict.fuzzy_get("git psuh", 2)};
+  ASSERT_EQ(found.size(), 1u);
+  EXPECT_EQ(std::string(found[0].word.begin(), found[0].word.end()), "git push");
+  EXPECT_EQ(found[0].distance, 2u);
+  found = dict.fuzzy_get("got pull", 1);
+  ASSERT_EQ(found.size(), 1u);
+  EXPECT_EQ(std::string(found[0].word.begin(), found[0].word.end()), "git pull");
+  found = dict.fuzzy_get("gi", 1);
+  ASSERT_EQ(found.size(), 1u);
+  EXPECT_EQ(std::string(found[0].word.begin(), found[0].word.end()), "go");
+}
+
+TEST(TestStatic, CompileTime){
+  static constexpr auto commands {makeStaticTree<[]{return std::array{"test", "test1", "test2", "tell", "a", "test", "\xc3\xbc" "ber"};}>()};
+  static_assert(commands.contains("test1"));
+  static_assert(commands.contains("\xc3\xbc" "ber"));
+  static_assert(!commands.contains("tes"));
+  static_assert(commands.get("tel").size() == 4);
+  static_assert(commands.get("x").empty());
+  static_assert(decltype(commands)::size() == 8);
+
+  auto as_string = [](span<const char> word){return std::string(word.begin(), word.end());};
+  EXPECT_EQ(as_string(commands.get("te")), "te");
+  EXPECT_EQ(as_string(commands.get("tes")), "test");
+  EXPECT_EQ(as_string(commands.get(std::string{"test2"})), "test2");
+  EXPECT_TRUE(commands.get("test3").empty());
+  vector<std::string> res;
+  for (auto word : commands.completions("te")) {
+    res.emplace_back(word.begin(), word.end());
+  }
+  EXPECT_THAT(res, ElementsAre("tell", "test", "test1", "test2"));
+}
+
+//  Counts bytes taken through it, memory comes from an upstream resource
+class CountingResource : public std::pmr::memory_resource {
+  public :
+    size_t allocated {0};
+    size_t deallocated {0};
+  private :
+    void* do_allocate(size_t bytes, size_t align) override {
+      allocated += bytes;
+      return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void* ptr, size_t bytes, size_t align) override {
+      deallocated += bytes;
+      std::pmr::new_delete_resource()->deallocate(ptr, bytes, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {return this == &other;}
+};
+
+TEST(TestAlloc, MemoryResource){
+  CountingResource counting;
+  {
+    radix_dict::pmr::RadixTree<char> radix {&counting};
+    size_t empty {counting.allocated};
+    EXPECT_GT(empty, 0u);
+    for (const auto word : {"test1", "test2", "tell", "a", "status", "start"}) {
+      EXPECT_TRUE(radix.ins(word));
+    }
+    EXPECT_GT(counting.allocated, empty);
+    auto res {radix.get("te")};
+    ASSERT_TRUE(res);
+    EXPECT_EQ(std::string(res->begin(), res->end()), "te");
+    EXPECT_TRUE(radix.erase("tell"));
+    radix.compact();
+    EXPECT_TRUE(radix.contains("test1"));
+    EXPECT_FALSE(radix.contains("tell"));
+    res = radix.get("sta");
+    ASSERT_TRUE(res);
+    EXPECT_EQ(std::string(res->begin(), res->end()), "sta");
+  }
+  EXPECT_EQ(counting.allocated, counting.deallocated);
+
+  std::pmr::monotonic_buffer_resource arena {&counting};
+  cli_dict::pmr::Dict<char> dict {'-', &arena};
+  EXPECT_TRUE(dict.ins("test1-ab"));
+  EXPECT_TRUE(dict.ins("test2-cd"));
+  auto item {dict.get("test1-a")};
+  ASSERT_TRUE(item);
+  EXPECT_EQ(std::string(item->begin(), item->end()), "test1-ab");
+  cli_dict::pmr::HierDict<char> cmd {' ', &arena};
+  EXPECT_TRUE(cmd.ins("tool sub action"));
+  item = cmd.get("t s a");
+  ASSERT_TRUE(item);
+  EXPECT_EQ(std::string(item->begin(), item->end()), "tool sub action");
+}
+
+//  Cursor after every typed and removed letter gives the same as get and contains of a whole typed word
+template <typename C> void checkCursor(const C& container, const std::vector<std::string>& inputs) {
+  auto as_string = [](const auto& res){return res ? std::string(res->begin(), res->end()) : std::string{"null"};};
+  auto cursor {container.cursor()};
+  for (const auto& input : inputs) {
+    auto check = [&](size_t len) {
+      std::string typed {input.substr(0, len)};
+      EXPECT_EQ(cursor.size(), len);
+      EXPECT_EQ(as_string(cursor.completion()), as_string(container.get(typed))) << typed;
+      EXPECT_EQ(cursor.complete(), container.contains(typed)) << typed;
+    };
+    for (size_t len = 1; len <= input.size(); ++len) {
+      cursor.push(input[len - 1]);
+      check(len);
+    }
+    for (size_t len = input.size(); len > 0; --len) {
+      cursor.pop();
+      check(len - 1);
+    }
+  }
+}
+
+TEST(TestCursor, Keystrokes){
+  RadixTree<char> radix {{'t', 'e', 's', 't'}, {'t', 'e', 's', 't', '1'}, {'t', 'e', 's', 't', '2'}, {'t', 'e', 'l', 'l'}, {'a'}};
+  checkCursor(radix, {"test1", "tell", "tex", "testing", "a", "b"});
+  auto cursor {radix.cursor()};
+  EXPECT_EQ(cursor.candidates(), 5u);
+  EXPECT_TRUE(cursor.push('t'));
+  EXPECT_EQ(std::string(cursor.extension().begin(), cursor.extension().end()), "e");
+  EXPECT_EQ(cursor.candidates(), 4u);
+  EXPECT_TRUE(cursor.push('e'));
+  EXPECT_TRUE(cursor.push('s'));
+  EXPECT_EQ(std::string(cursor.extension().begin(), cursor.extension().end()), "t");
+  EXPECT_EQ(cursor.candidates(), 3u);
+  EXPECT_FALSE(cursor.complete());
+  EXPECT_TRUE(cursor.push('t'));
+  EXPECT_TRUE(cursor.complete());
+  EXPECT_FALSE(cursor.push('x'));
+  EXPECT_FALSE(cursor.push('y'));
+  EXPECT_FALSE(cursor.valid());
+  EXPECT_EQ(cursor.candidates(), 0u);
+  cursor.pop();
+  cursor.pop();
+  EXPECT_TRUE(cursor.valid());
+  EXPECT_TRUE(cursor.push('1'));
+  EXPECT_EQ(cursor.candidates(), 1u);
+  cursor.clear();
+  EXPECT_EQ(cursor.size(), 0u);
+  EXPECT_EQ(cursor.candidates(), 5u);
+
+  Dict<char> dict {'-', {{'t', 'e', 's', 't', '1', '-', 'a', 'b'}, {'t', 'e', 's', 't', '1', '-', 'a', 'c'}, {'t', 'e', 's', 't', '1'},
+                         {'t', 'e', 's', 't', '2', '-', 'x', '-', 'y'}, {'t', 'e', 'l', 'l'}}};
+  checkCursor(dict, {"test1-ab", "te-a", "test1-", "tell-x", "test2-x-y", "-a", "test1-ad"});
+  auto items {dict.cursor()};
+  for (char letter : std::string{"test1-"}) {
+    items.push(letter);
+  }
+  EXPECT_EQ(items.candidates(), 3u);
+  items.push('a');
+  EXPECT_EQ(items.candidates(), 2u);
+
+  HierDict<char> cmd {' '};
+  for (const auto item : {"tool sub action", "tool sub list", "tool other", "tool", "git commit --amend"}) {
+    cmd.ins(item);
+  }
+  checkCursor(cmd, {"t s a", "tool sub list", "t  s", " t", "tool ", "tool other x", "g c --a", "t o"});
+}
+
+//  Counts, k-th items and ranks agree with completions for every prefix of every item
+template <typename C> void checkCounts(const C& container) {
+  std::vector<std::string> all;
+  for (auto word : container.completions("")) {
+    all.emplace_back(word.begin(), word.end());
+  }
+  EXPECT_EQ(container.count_prefix(""), all.size());
+  for (size_t pos = 0; pos < all.size(); ++pos) {
+    EXPECT_EQ(container.rank(all[pos]), pos) << all[pos];
+    for (size_t len = 1; len <= all[pos].size(); ++len) {
+      std::string prefix {all[pos].substr(0, len)};
+      std::vector<std::string> page;
+      for (auto word : container.completions(prefix)) {
+        page.emplace_back(word.begin(), word.end());
+      }
+      EXPECT_EQ(container.count_prefix(prefix), page.size()) << prefix;
+      EXPECT_EQ(container.is_unique(prefix), page.size() == 1) << prefix;
+      for (size_t k = 0; k < page.size(); ++k) {
+        auto item {container.kth(prefix, k)};
+        ASSERT_TRUE(item) << prefix << " " << k;
+        EXPECT_EQ(std::string(item->begin(), item->end()), page[k]);
+      }
+      EXPECT_FALSE(container.kth(prefix, page.size()));
+    }
+  }
+}
+
+TEST(TestCounts, PrefixCounts){
+  RadixTree<char> radix {{'t', 'e', 's', 't'}, {'t', 'e', 's', 't', '1'}, {'t', 'e', 's', 't', '2'}, {'t', 'e', 'l', 'l'}, {'a'}};
+  EXPECT_EQ(radix.count_prefix("te"), 4u);
+  EXPECT_EQ(radix.count_prefix("tes"), 3u);
+  EXPECT_EQ(radix.count_prefix("x"), 0u);
+  EXPECT_TRUE(radix.is_unique("tel"));
+  EXPECT_FALSE(radix.is_unique("test"));
+  EXPECT_EQ(radix.rank("b"), 1u);
+  EXPECT_EQ(radix.rank("tesa"), 2u);
+  EXPECT_EQ(radix.rank("test0"), 3u);
+  EXPECT_EQ(radix.rank("zzz"), 5u);
+  checkCounts(radix);
+  EXPECT_TRUE(radix.erase("test"));
+  EXPECT_TRUE(radix.erase("a"));
+  EXPECT_EQ(radix.count_prefix(""), 3u);
+  checkCounts(radix);
+  radix.compact();
+  checkCounts(radix);
+
+  auto sorted = RadixTree<char>::build_sorted(std::vector<std::string>{"abc", "abd", "abd", "b", "a"});
+  EXPECT_EQ(sorted.count_prefix(""), 4u);
+  checkCounts(sorted);
+
+  Dict<char> dict {'-', {{'t', 'e', 's', 't', '1', '-', 'a', 'b'}, {'t', 'e', 's', 't', '1', '-', 'a', 'c'}, {'t', 'e', 's', 't', '1'},
+                         {'t', 'e', 's', 't', '1', 'x'}, {'t', 'e', 's', 't', '1', '+'}, {'t', 'e', 's', 't', '2', '-', 'x', '-', 'y'}, {'t', 'e', 'l', 'l'}}};
+  EXPECT_EQ(dict.count_prefix("test1"), 5u);
+  EXPECT_EQ(dict.count_prefix("test1-"), 2u);
+  EXPECT_TRUE(dict.is_unique("test2-x-"));
+  checkCounts(dict);
+  EXPECT_TRUE(dict.erase("test1-ab"));
+  EXPECT_EQ(dict.count_prefix("test1"), 4u);
+  checkCounts(dict);
+
+  auto as_string = [](const auto& res){return res ? std::string(res->begin(), res->end()) : std::string{"null"};};
+  HierDict<char> cmd {' '};
+  for (const auto item : {"tool sub action", "tool sub list", "tool other", "tool", "tool-x", "git commit --amend"}) {
+    cmd.ins(item);
+  }
+  EXPECT_EQ(cmd.count_prefix("t"), 5u);
+  EXPECT_EQ(cmd.count_prefix("tool s"), 2u);
+  EXPECT_EQ(cmd.count_prefix("tool sub "), 2u);
+  EXPECT_TRUE(cmd.is_unique("g"));
+  for (size_t k = 0; k < cmd.count_prefix(""); ++k) {
+    auto item {cmd.kth("", k)};
+    ASSERT_TRUE(item);
+    EXPECT_EQ(cmd.rank(span<const char>{*item}), k);
+  }
+  EXPECT_EQ(as_string(cmd.kth("tool s", 1)), "tool sub list");
+  EXPECT_TRUE(cmd.erase("tool sub list"));
+  EXPECT_EQ(cmd.count_prefix("t"), 4u);
+  auto cursor {cmd.cursor()};
+  cursor.push('t');
+  EXPECT_EQ(cursor.candidates(), 4u);
+}
+
+TEST(TestMap, RadixMap){
+  RadixMap<char, int> map {{{'t', 'e', 's', 't', '1'}, 1}, {{'t', 'e', 'l', 'l'}, 2}};
+  EXPECT_TRUE(map.ins("test", 3));
+  EXPECT_TRUE(map.ins(std::string{"a"}, 4));
+  EXPECT_FALSE(map.ins("tell", 5));
+  ASSERT_TRUE(map.find("tel"));
+  EXPECT_EQ(*map.find("tel"), 2);
+  EXPECT_EQ(*map.find("test1"), 1);
+  EXPECT_EQ(*map.find("tes"), 3);
+  EXPECT_EQ(map.find("te"), nullptr);
+  EXPECT_EQ(map.find("x"), nullptr);
+  EXPECT_EQ(map.find(""), nullptr);
+  EXPECT_EQ(map.find_exact("tel"), nullptr);
+  ASSERT_TRUE(map.find_exact("test"));
+  *map.find_exact("test") = 30;
+  EXPECT_EQ(*std::as_const(map).find("tes"), 30);
+
+  EXPECT_TRUE(map.erase("test"));
+  EXPECT_FALSE(map.erase("test"));
+  EXPECT_EQ(*map.find("tes"), 1);
+  EXPECT_TRUE(map.ins("tea", 6));
+  map.compact();
+  EXPECT_EQ(*map.find("test"), 1);
+  EXPECT_EQ(*map.find("tea"), 6);
+  EXPECT_EQ(*map.find("a"), 4);
+  EXPECT_TRUE(map.contains("tell"));
+
+  RadixMap<char, std::unique_ptr<std::string>> handlers;
+  EXPECT_TRUE(handlers.ins("status", std::make_unique<std::string>("status handler")));
+  EXPECT_TRUE(handlers.ins("start", std::make_unique<std::string>("start handler")));
+  ASSERT_TRUE(handlers.find("statu"));
+  EXPECT_EQ(**handlers.find("statu"), "status handler");
+}
+
+TEST(TestMap, DictMap){
+  DictMap<char, std::string> map {'-', {{{'t', 'e', 's', 't', '1', '-', 'a', 'b'}, "ab"}, {{'t', 'e', 's', 't', '1'}, "test1"}}};
+  EXPECT_TRUE(map.ins("test2-x-y", "xy"));
+  EXPECT_TRUE(map.ins("test1-ac", "ac"));
+  EXPECT_FALSE(map.ins("-a", "none"));
+  EXPECT_EQ(*map.find("test1-ab"), "ab");
+  EXPECT_EQ(*map.find("test2-x"), "xy");
+  EXPECT_EQ(map.find("test2-"), nullptr);
+  EXPECT_EQ(*map.find("test1-"), "test1");
+  EXPECT_EQ(*map.find("test1"), "test1");
+  EXPECT_EQ(map.find("test1-a"), nullptr);
+  EXPECT_EQ(map.find("te-ab"), nullptr);
+  EXPECT_EQ(*map.find("test1-ac"), "ac");
+  EXPECT_EQ(map.find_exact("test1-a"), nullptr);
+  EXPECT_EQ(*map.find_exact("test2-x-y"), "xy");
+
+  EXPECT_TRUE(map.erase("test1-ab"));
+  EXPECT_FALSE(map.erase("test1-ab"));
+  EXPECT_EQ(*map.find("test1-a"), "ac");
+  EXPECT_TRUE(map.ins("test1-ab", "ab2"));
+  EXPECT_EQ(*map.find("test1-ab"), "ab2");
+  map.clear();
+  EXPECT_EQ(map.find("test1"), nullptr);
+  EXPECT_TRUE(map.ins("test1", "again"));
+  EXPECT_EQ(*map.find("t"), "again");
+}
+
+//  Common prefix of labels differing at every position, or equal, against a letter by letter compare
+template <typename T> void checkPrefixKernel() {
+  for (size_t len : {0, 1, 7, 15, 16, 17, 31, 32, 33, 64, 100}) {
+    vector<T> left(len);
+    for (size_t pos = 0; pos < len; ++pos) {
+      left[pos] = static_cast<T>(pos % 23 + 1);
+    }
+    for (size_t diff = 0; diff <= len; ++diff) {
+      vector<T> right {left};
+      if (diff < len) {
+        right[diff] = static_cast<T>(100);
+      }
+      EXPECT_EQ(commonPrefix<T>(left, right), diff);
+      EXPECT_EQ(commonPrefix<T>(span<const T>{left}.first(diff), right), diff);
+      EXPECT_EQ(commonPrefix<T>(left, span<const T>{right}.subspan(0, diff)), diff);
+    }
+  }
+}
+
+TEST(TestKernel, CommonPrefix){
+  checkPrefixKernel<char>();
+  checkPrefixKernel<char8_t>();
+  checkPrefixKernel<char16_t>();
+  checkPrefixKernel<char32_t>();
+  checkPrefixKernel<int>();
+  checkPrefixKernel<double>();
+  static_assert(commonPrefix<char>(std::string_view{"status"}, std::string_view{"start"}) == 3);
+}
+
+//  Words of a bulk insert by threads against the same words inserted one by one
+template <typename C> void checkBulk(C&& bulk, C&& serial, const std::vector<std::string>& words) {
+  size_t inserted {0};
+  for (const auto& word : words) {
+    inserted += serial.ins(word);
+  }
+  EXPECT_EQ(bulk.bulk_insert(words, 4), inserted);
+  std::vector<std::string> expected, got;
+  for (auto word : serial.completions("")) {
+    expected.emplace_back(word.begin(), word.end());
+  }
+  for (auto word : bulk.completions("")) {
+    got.emplace_back(word.begin(), word.end());
+  }
+  EXPECT_EQ(got, expected);
+  EXPECT_EQ(bulk.count_prefix(""), inserted);
+  for (size_t pos = 0; pos < words.size(); pos += 97) {
+    for (size_t len = 1; len <= words[pos].size(); len += 3) {
+      EXPECT_EQ(bulk.count_prefix(words[pos].substr(0, len)), serial.count_prefix(words[pos].substr(0, len)));
+    }
+  }
+}
+
+//  Stateless allocator failing over a limit of bytes shared by all its instances
+std::atomic<size_t> limited_bytes {0};
+std::atomic<size_t> bytes_limit {std::numeric_limits<size_t>::max()};
+template <typename T> struct LimitedAllocator {
+  using value_type = T;
+  LimitedAllocator() = default;
+  template <typename U> LimitedAllocator(const LimitedAllocator<U>&) noexcept {}
+  T* allocate(size_t count) {
+    if (limited_bytes += count * sizeof(T); limited_bytes > bytes_limit) {
+      limited_bytes -= count * sizeof(T);
+      throw std::bad_alloc{};
+    }
+    return std::allocator<T>{}.allocate(count);
+  }
+  void deallocate(T* ptr, size_t count) noexcept {
+    limited_bytes -= count * sizeof(T);
+    std::allocator<T>{}.deallocate(ptr, count);
+  }
+  friend bool operator== (const LimitedAllocator&, const LimitedAllocator&) noexcept {return true;}
+};
+
+TEST(TestBulk, Threads){
+  std::mt19937 gen {20};
+  std::uniform_int_distribution<int> letter {'a', 'z'}, length {1, 12};
+  std::vector<std::string> random, skewed, items;
+  for (size_t count = 0; count < 40000; ++count) {
+    std::string word(static_cast<size_t>(length(gen)), ' ');
+    ranges::generate(word, [&]{return static_cast<char>(letter(gen));});
+    random.push_back(word);
+    skewed.push_back("git-" + word.substr(0, word.size() % 3) + "-" + word);
+    items.push_back(word.substr(0, word.size() / 2 + 1) + (word.size() % 2 ? "-" + word : ""));
+  }
+  random.insert(random.end(), {"g", "gi", "git", "git-", "a"});
+  skewed.insert(skewed.end(), {"g", "gi", "git", "git-", "a"});
+  checkBulk(RadixTree<char>{}, RadixTree<char>{}, random);
+  checkBulk(RadixTree<char>{}, RadixTree<char>{}, skewed);
+  checkBulk(Dict<char>{'-'}, Dict<char>{'-'}, items);
+  checkBulk(Dict<char>{'-'}, Dict<char>{'-'}, skewed);
+  std::vector<std::string> levels, tools;
+  for (size_t count = 0; count < random.size(); ++count) {
+    const auto& word {random[count]};
+    levels.push_back(word.substr(0, word.size() / 2 + 1) + (word.size() % 2 ? " " + word + (count % 3 ? "" : " " + word.substr(1) + "x") : ""));
+  }
+  for (size_t count = 0; count < 20000; ++count) {
+    tools.push_back("tool x" + std::to_string(count));
+  }
+  checkBulk(HierDict<char>{' '}, HierDict<char>{' '}, levels);
+  HierDict<char> hier {' '};
+  EXPECT_EQ(hier.bulk_insert(tools, 4), tools.size());
+  EXPECT_TRUE(hier.contains("tool x5"));
+  EXPECT_EQ(hier.count_prefix("tool "), tools.size());
+  auto item {hier.get("t x19999")};
+  ASSERT_TRUE(item);
+  EXPECT_EQ(std::string(item->begin(), item->end()), "tool x19999");
+
+  //  A part tree failing in a thread - the exception comes to the caller, the tree stays empty
+  RadixTree<char, LimitedAllocator<char>> failing;
+  bytes_limit = limited_bytes + (1 << 16);
+  EXPECT_THROW(failing.bulk_insert(random, 4), std::bad_alloc);
+  bytes_limit = std::numeric_limits<size_t>::max();
+  EXPECT_EQ(failing.count_prefix(""), 0u);
+  EXPECT_FALSE(failing.contains("git"));
+  RadixTree<char> serial;
+  for (const auto& word : random) {
+    serial.ins(word);
+  }
+  EXPECT_EQ(failing.bulk_insert(random, 4), serial.count_prefix(""));
+
+  RadixTree<char> small;  //  Not empty, one by one
+  small.ins("git");
+  small.ins("gits");
+  EXPECT_EQ(small.bulk_insert(std::vector<std::string>{"git", "github", "a"}, 4), 2u);
+  EXPECT_EQ(small.count_prefix("git"), 3u);
+}
+
+//  Merge of two containers against all words inserted into one
+template <typename Make> void checkMerge(Make make, const std::vector<std::string>& base_words, const std::vector<std::string>& plugin_words) {
+  auto base {make()}, plugin {make()}, serial {make()};
+  for (const auto& word : base_words) {
+    base.ins(word);
+    serial.ins(word);
+  }
+  size_t added {0};
+  for (const auto& word : plugin_words) {
+    plugin.ins(word);
+    added += serial.ins(word);
+  }
+  EXPECT_EQ(base.merge(std::move(plugin)), added);
+  EXPECT_EQ(plugin.count_prefix(""), 0u);
+  std::vector<std::string> expected, got;
+  for (auto word : serial.completions("")) {
+    expected.emplace_back(word.begin(), word.end());
+  }
+  for (auto word : base.completions("")) {
+    got.emplace_back(word.begin(), word.end());
+  }
+  EXPECT_EQ(got, expected);
+  checkCounts(base);
+  for (const auto& word : plugin_words) {
+    EXPECT_TRUE(base.contains(word)) << word;
+  }
+  EXPECT_TRUE(base.erase(plugin_words.front()));
+  EXPECT_FALSE(base.contains(plugin_words.front()));
+  base.compact();
+  EXPECT_EQ(base.count_prefix(""), expected.size() - 1);
+}
+
+TEST(TestMerge, Trees){
+  const std::vector<std::string> base {"git-commit", "git-status", "git-stash", "gitk", "docker-run", "docker", "make", "tar-x"};
+  const std::vector<std::string> plugin {"git-stash-pop", "git-st", "git", "gi", "git-status", "docker-ps", "kubectl-get", "m", "tar-xz-f", "tar"};
+  auto make_radix = []{return RadixTree<char>{};};
+  auto make_dict = []{return Dict<char>{'-'};};
+  checkMerge(make_radix, base, plugin);
+  checkMerge(make_radix, plugin, base);
+  checkMerge(make_dict, base, plugin);
+  checkMerge(make_dict, plugin, base);
+
+  HierDict<char> cmd {' '}, extra {' '};
+  cmd.ins("git stash pop");
+  cmd.ins("git status");
+  extra.ins("git stash list");
+  extra.ins("git status");
+  extra.ins("go build");
+  EXPECT_EQ(cmd.merge(std::move(extra)), 2u);
+  auto as_string = [](const auto& res){return res ? std::string(res->begin(), res->end()) : std::string{"null"};};
+  EXPECT_EQ(as_string(cmd.get("gi stas l")), "git stash list");
+  EXPECT_EQ(as_string(cmd.get("go b")), "go build");
+  EXPECT_EQ(cmd.count_prefix(""), 4u);
+
+  Dict<char> dict {'-'}, other {' '};
+  dict.ins("test1-a");
+  other.ins("test1 b");
+  EXPECT_EQ(dict.merge(std::move(other)), 0u);  //  Different delimiters
+  EXPECT_TRUE(other.contains("test1 b"));
+  EXPECT_EQ(dict.merge(std::move(dict)), 0u);
+  EXPECT_TRUE(dict.contains("test1-a"));
+}
+
+TEST(TestJournal, Reload){
+  const auto dir {std::filesystem::temp_directory_path() / ("clidict_journal_" + std::to_string(::getpid()))};
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  const auto path {dir / "cmd.img"};
+  {
+    JournalDict<char> writer {'-', path};
+    ASSERT_TRUE(writer.valid());
+    EXPECT_TRUE(writer.ins("test1-a"));
+    EXPECT_TRUE(writer.ins("test1-b"));
+    EXPECT_TRUE(writer.ins("test2"));
+    EXPECT_FALSE(writer.ins("test2"));
+    EXPECT_TRUE(writer.erase("test1-b"));
+
+    JournalDict<char> reader {'-', path};
+    ASSERT_TRUE(reader.valid());
+    EXPECT_TRUE(reader.contains("test1-a"));
+    EXPECT_FALSE(reader.contains("test1-b"));
+    EXPECT_EQ(reader.count_prefix(""), 2u);
+    EXPECT_EQ(reader.rank("test2"), 1u);
+    static_assert(!std::is_convertible_v<JournalDict<char>&, Dict<char>&>);  //  No changes around the journal
+
+    EXPECT_TRUE(writer.ins("tell-x"));
+    EXPECT_EQ(reader.reload(), 1u);
+    EXPECT_TRUE(reader.contains("tell-x"));
+    EXPECT_EQ(reader.reload(), 0u);
+
+    //  A record torn by a write in progress is applied when it is complete
+    const std::string tail {"abc"};
+    const std::uint32_t len {static_cast<std::uint32_t>(tail.size())};
+    std::ofstream raw {dir / "cmd.img.journal", std::ios::binary | std::ios::app};
+    raw.put(1).write(reinterpret_cast<const char*>(&len), sizeof(len)).write(tail.data(), 1).flush();
+    EXPECT_EQ(reader.reload(), 0u);
+    raw.write(tail.data() + 1, 2).flush();
+    EXPECT_EQ(reader.reload(), 1u);
+    EXPECT_TRUE(reader.contains("abc"));
+
+    //  A new generation is loaded from the checkpoint
+    EXPECT_TRUE(writer.checkpoint());
+    EXPECT_EQ(std::filesystem::file_size(dir / "cmd.img.journal"), 24u);
+    EXPECT_TRUE(writer.ins("zip"));
+    EXPECT_EQ(reader.reload(), 1u);
+    EXPECT_TRUE(reader.contains("zip"));
+    EXPECT_FALSE(reader.contains("abc"));  //  Not in the writer
+    EXPECT_EQ(reader.count_prefix(""), 4u);
+    writer.clear();
+    EXPECT_TRUE(writer.ins("tar-x"));
+  }
+  JournalDict<char> reopened {'-', path};
+  ASSERT_TRUE(reopened.valid());
+  EXPECT_EQ(reopened.count_prefix(""), 1u);
+  EXPECT_TRUE(reopened.contains("tar-x"));
+
+  JournalDict<char> other_delim {' ', path};
+  EXPECT_FALSE(other_delim.valid());
+  std::filesystem::remove_all(dir);
+}
+
+//  Lookups of a container as strings, to compare a minimized container with the original one
+template <typename C> std::vector<std::string> lookups(const C& container, const std::vector<std::string>& queries) {
+  auto as_string = [](const auto& res){return res ? std::string(res->begin(), res->end()) : std::string{"null"};};
+  std::vector<std::string> results;
+  for (const auto& query : queries) {
+    results.push_back(as_string(container.get(query)) + " " + std::to_string(container.contains(query)) + " " +
+                      std::to_string(container.count_prefix(query)) + " " + std::to_string(container.rank(query)) + " " + as_string(container.kth(query, 1)));
+    for (auto word : container.completions(query)) {
+      results.emplace_back(word.begin(), word.end());
+    }
+  }
+  return results;
+}
+
+TEST(TestMinimize, SharedSubtrees){
+  const std::vector<std::string> options {"--help", "--verbose", "--version", "-f", "--output"};
+  std::vector<std::string> items, queries {"", "t", "tool1", "tool1-", "tool1--v", "tool12--h", "tool3-f", "tool4-x", "tool"};
+  Dict<char> dict {' '}, plain {' '};
+  for (size_t tool = 0; tool < 40; ++tool) {
+    for (const auto& option : options) {
+      items.push_back("tool" + std::to_string(tool) + " " + option);
+      dict.ins(items.back());
+      plain.ins(items.back());
+    }
+    queries.push_back("tool" + std::to_string(tool) + " --ver");
+  }
+  for (const auto& item : items) {
+    queries.push_back(item);
+  }
+  const auto expected {lookups(plain, queries)};
+  const size_t nodes {dict.stats().nodes};
+  const size_t dropped {dict.minimize()};
+  EXPECT_GT(dropped, 39u * 7);  //  Option trees of 39 tools at least
+  EXPECT_EQ(dict.stats().nodes, nodes - dropped);
+  EXPECT_EQ(lookups(dict, queries), expected);
+  const auto image {dict.freeze()};
+  EXPECT_LT(image.size(), plain.freeze().size());
+  FrozenDict<char> frozen {image};
+  for (const auto& item : items) {
+    EXPECT_TRUE(frozen.contains(item)) << item;
+  }
+
+  //  Changes go to own copies of shared nodes
+  EXPECT_TRUE(dict.ins("tool1 --extra"));
+  EXPECT_TRUE(dict.contains("tool1 --extra"));
+  EXPECT_FALSE(dict.contains("tool2 --extra"));
+  EXPECT_TRUE(dict.erase("tool1 --extra"));
+  EXPECT_EQ(lookups(dict, queries), expected);
+  EXPECT_TRUE(dict.erase("tool3 -f"));
+  EXPECT_FALSE(dict.contains("tool3 -f"));
+  EXPECT_TRUE(dict.contains("tool4 -f"));
+
+  RadixTree<char> radix;
+  for (std::string word : {"walk", "walking", "walked", "walks", "talk", "talking", "talked", "talks"}) {
+    radix.ins(word);
+  }
+  EXPECT_EQ(radix.minimize(), 3u);  //  ing, ed and s of talk
+  EXPECT_EQ(radix.count_prefix("ta"), 4u);
+  EXPECT_EQ(radix.rank("walked"), 5u);
+  EXPECT_TRUE(radix.ins("walker"));
+  EXPECT_FALSE(radix.contains("talker"));
+}
+
+//  Case insensitive letters with underscores equal to dashes
+struct CommandTraits {
+  static constexpr char key(char letter) noexcept {return letter == '_' ? '-' : CaseInsensitiveTraits<char>::key(letter);}
+};
+template <typename C> constexpr bool freezable {requires (const C& container) {container.freeze();}};
+
+TEST(TestTraits, FoldedLetters){
+  auto as_string = [](const auto& res){return res ? std::string(res->begin(), res->end()) : std::string{"null"};};
+  RadixTree<char, std::allocator<char>, CaseInsensitiveTraits<char>> tree;
+  EXPECT_TRUE(tree.ins("Git"));
+  EXPECT_FALSE(tree.ins("GIT"));
+  EXPECT_TRUE(tree.ins("GitHub"));
+  EXPECT_TRUE(tree.ins("gitk"));
+  EXPECT_TRUE(tree.ins("Make"));
+  EXPECT_TRUE(tree.ins("cmake"));
+  EXPECT_TRUE(tree.contains("git"));
+  EXPECT_TRUE(tree.contains("GITHUB"));
+  EXPECT_EQ(as_string(tree.get("githu")), "gitHub");  //  Typed letters and the rest as inserted
+  EXPECT_EQ(tree.count_prefix("GI"), 3u);
+  std::vector<std::string> all;
+  for (auto word : tree.completions("")) {
+    all.emplace_back(word.begin(), word.end());
+  }
+  EXPECT_EQ(all, (std::vector<std::string>{"cmake", "Git", "GitHub", "Gitk", "Make"}));
+  checkCounts(tree);
+  auto cur {tree.cursor()};
+  for (char letter : std::string{"GITH"}) {
+    EXPECT_TRUE(cur.push(letter));
+  }
+  EXPECT_EQ(as_string(cur.completion()), "GITHub");
+  EXPECT_FALSE(cur.complete());
+  EXPECT_TRUE(tree.erase("GITK"));
+  EXPECT_FALSE(tree.contains("gitk"));
+
+  Dict<char, std::allocator<char>, CommandTraits> dict {' '};
+  EXPECT_TRUE(dict.ins("docker run --dry_run"));
+  EXPECT_TRUE(dict.ins("docker ps"));
+  EXPECT_FALSE(dict.ins("Docker PS"));
+  EXPECT_TRUE(dict.contains("DOCKER run --DRY-RUN"));
+  EXPECT_EQ(as_string(dict.get("Dock r")), "docker run --dry_run");
+  EXPECT_EQ(dict.count_prefix("DOCKER "), 2u);
+  checkCounts(dict);
+  Dict<char, std::allocator<char>, CommandTraits> plugin {' '};
+  plugin.ins("DOCKER PS");
+  plugin.ins("docker_compose up");
+  EXPECT_EQ(dict.merge(std::move(plugin)), 1u);
+  EXPECT_TRUE(dict.contains("docker-compose UP"));
+  static_assert(!freezable<decltype(dict)> && freezable<Dict<char>>);  //  Images compare letters as they are
+}
+
+//  Lookups of a container are callable, deleted ones are not
+template <typename C> constexpr bool viewable {requires (const C& container, const std::string& word, char* out) {
+  container.get_view(word);
+  container.get_to(word, out);
+}};
+
+TEST(TestGetTo, NoAllocations){
+  auto as_string = [](const auto& res){return res ? std::string(res->begin(), res->end()) : std::string{"null"};};
+  auto view_string = [](const auto& view){
+    std::string ret;
+    if (view) {
+      view->copy(std::back_inserter(ret));
+      EXPECT_EQ(ret.size(), view->size());
+    }
+    return view ? ret : std::string{"null"};
+  };
+  CountingResource counting;
+  radix_dict::pmr::RadixTree<char> tree {&counting};
+  cli_dict::pmr::Dict<char> dict {'-', &counting};
+  for (std::string word : {"test1", "test2", "tent", "walk", "walker", "w"}) {
+    tree.ins(word);
+  }
+  for (std::string item : {"test1-ab", "test1-ac", "test2", "walk-er", "walk-fast-now"}) {
+    dict.ins(item);
+  }
+  for (std::string query : {"", "t", "te", "tes", "test1", "test3", "ten", "wa", "walke", "w", "x"}) {
+    EXPECT_EQ(view_string(tree.get_view(query)), as_string(tree.get(query))) << query;
+  }
+  for (std::string query : {"", "t", "test1", "test1-", "test1-a", "test1-ab", "test2-", "test2-a", "wa-e", "walk-f", "walk-", "x", "-ab"}) {
+    EXPECT_EQ(view_string(dict.get_view(query)), as_string(dict.get(query))) << query;
+  }
+
+  std::array<char, 64> buffer {};
+  const std::string word {"walke"}, item {"wa-f"}, missing {"test1-x"};
+  size_t before {counting.allocated};
+  auto tree_end {tree.get_to(word, buffer.begin())};
+  auto dict_end {dict.get_to(item, buffer.begin() + 8)};
+  auto not_found {dict.get_to(missing, buffer.begin() + 32)};
+  EXPECT_EQ(counting.allocated, before);
+  ASSERT_TRUE(tree_end && dict_end);
+  EXPECT_EQ(std::string(buffer.begin(), *tree_end), "walker");
+  EXPECT_EQ(std::string(buffer.begin() + 8, *dict_end), "walk-fast-now");
+  EXPECT_FALSE(not_found);
+  EXPECT_EQ(buffer[32], '\0');
+  static_assert(viewable<Dict<char>> && viewable<RadixTree<char>> && !viewable<HierDict<char>>);  //  Items of many levels are got by get
+}
+
 GTEST_API_ int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();